@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "fr_commun.h"
+
+// Index des anagrammes : les mots d'une liste sont regroupés selon leur
+// signature, la suite de leurs caractères triés. Comme dans la liste fournie
+// (forme décomposée, « é » s'écrit e suivi de l'accent U+0301), un accent
+// compte comme une lettre à part : « aberré » et « barrée » sont anagrammes,
+// « barree » non. Les lettres accentuées précomposées saisies par l'utilisateur
+// sont décomposées de la même façon avant le calcul de la signature.
+// Tous les anagrammes d'un mot s'obtiennent en hachant sa signature : une seule
+// alvéole est parcourue.
+// Le même index régénère Tables/anagrammes.dat à partir de Mots/anagrammes_mots.txt.
+
+// Structures
+// Groupe d'anagrammes : les mots d'une même signature, dans l'ordre de la liste
+typedef struct group {
+    char* signature;
+    char** words;
+    int nbWords;
+    int capacity;
+    struct group* next;
+} t_group;
+
+typedef struct {
+    t_group** slots;
+    int nbSlots;
+    int nbGroups;
+    int nbWords;
+    t_group** groups;    // Groupes dans l'ordre d'apparition de leur premier mot
+    int groupsCapacity;
+    char** words;        // Mots dans l'ordre de la liste (sans doublon)
+    int wordsCapacity;
+    t_arena* arena;      // Propriétaire des signatures, des mots et des groupes
+} t_anagramIndex;
+
+// Taille initiale ; l'index double quand il y a plus de groupes que d'alvéoles
+#define INITIAL_NB_SLOTS 1024
+// Groupes cités en commentaire de la table générée : au moins ce nombre de mots
+#define MIN_LISTED_GROUP 9
+
+// Prototypes
+int characterLength(unsigned char first);
+void decomposeWord(const char* word, char* decomposed);
+void computeSignature(const char* word, char* signature);
+unsigned int hashSignature(const char* signature, int nbSlots);
+t_anagramIndex* createIndex(void);
+t_group* findGroup(t_anagramIndex* index, const char* signature, int* probes);
+void growIndex(t_anagramIndex* index);
+void addWord(t_anagramIndex* index, const char* word);
+t_anagramIndex* loadWordList(const char* filename);
+void searchAnagrams(t_anagramIndex* index, const char* word);
+int compareListedGroups(const void* a, const void* b);
+void generateTable(t_anagramIndex* index, FILE* output);
+void freeIndex(t_anagramIndex* index);
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[1], "-g") != 0)) {
+        fprintf(stderr, "Usage: %s [-g] <liste de mots>\n", argv[0]);
+        fprintf(stderr, "  sans option, affiche les anagrammes des mots saisis\n");
+        fprintf(stderr, "  -g écrit sur la sortie standard la table des anagrammes (format de Tables/anagrammes.dat)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t_anagramIndex* index = loadWordList(argv[argc - 1]);
+
+    if (argc == 3) {
+        generateTable(index, stdout);
+        freeIndex(index);
+        return 0;
+    }
+
+    printf("%d mots indexés en %d groupes d'anagrammes\n", index->nbWords, index->nbGroups);
+    printf("Saisir les mots recherchés :\n\n");
+
+    char word[1000];
+    while (fgets(word, sizeof(word), stdin)) {
+        size_t len = strlen(word);
+        if (len > 0 && word[len - 1] == '\n') word[len - 1] = '\0';
+        if (strlen(word) == 0) break;
+        searchAnagrams(index, word);
+    }
+
+    freeIndex(index);
+    return 0;
+}
+
+// Nombre d'octets du caractère UTF-8 commençant par first (1 si l'octet est invalide)
+int characterLength(unsigned char first) {
+    if (first >= 0xF0 && first < 0xF8) return 4;
+    if (first >= 0xE0) return first < 0xF0 ? 3 : 1;
+    if (first >= 0xC0) return 2;
+    return 1;
+}
+
+// Décomposition des lettres latines accentuées U+00C0 à U+00FF : lettre de
+// base suivie de l'accent combinant (NULL si le caractère reste tel quel)
+const char* latin1Decomposition[64] = {
+    "A\xCC\x80", "A\xCC\x81", "A\xCC\x82", "A\xCC\x83", "A\xCC\x88", "A\xCC\x8A", NULL, "C\xCC\xA7",
+    "E\xCC\x80", "E\xCC\x81", "E\xCC\x82", "E\xCC\x88", "I\xCC\x80", "I\xCC\x81", "I\xCC\x82", "I\xCC\x88",
+    NULL, "N\xCC\x83", "O\xCC\x80", "O\xCC\x81", "O\xCC\x82", "O\xCC\x83", "O\xCC\x88", NULL,
+    NULL, "U\xCC\x80", "U\xCC\x81", "U\xCC\x82", "U\xCC\x88", "Y\xCC\x81", NULL, NULL,
+    "a\xCC\x80", "a\xCC\x81", "a\xCC\x82", "a\xCC\x83", "a\xCC\x88", "a\xCC\x8A", NULL, "c\xCC\xA7",
+    "e\xCC\x80", "e\xCC\x81", "e\xCC\x82", "e\xCC\x88", "i\xCC\x80", "i\xCC\x81", "i\xCC\x82", "i\xCC\x88",
+    NULL, "n\xCC\x83", "o\xCC\x80", "o\xCC\x81", "o\xCC\x82", "o\xCC\x83", "o\xCC\x88", NULL,
+    NULL, "u\xCC\x80", "u\xCC\x81", "u\xCC\x82", "u\xCC\x88", "y\xCC\x81", NULL, "y\xCC\x88",
+};
+
+// Recopie de word dans decomposed (au plus 3 octets pour 2 lus) en décomposant
+// les lettres accentuées précomposées (codées C3 80 à C3 BF)
+void decomposeWord(const char* word, char* decomposed) {
+    while (*word) {
+        unsigned char c = *word;
+        const char* replacement = NULL;
+        if (c == 0xC3 && (unsigned char)word[1] >= 0x80 && (unsigned char)word[1] <= 0xBF) {
+            replacement = latin1Decomposition[(unsigned char)word[1] - 0x80];
+        }
+        if (replacement) {
+            strcpy(decomposed, replacement);
+            decomposed += strlen(replacement);
+            word += 2;
+        } else {
+            *decomposed++ = *word++;
+        }
+    }
+    *decomposed = '\0';
+}
+
+// Signature d'un mot : ses caractères triés, une fois les lettres accentuées
+// décomposées (signature doit pouvoir contenir 2 * strlen(word) + 1 octets).
+// Trier les octets de chaque caractère comme un tout revient à trier les points de code.
+void computeSignature(const char* text, char* signature) {
+    char word[2 * strlen(text) + 1];
+    decomposeWord(text, word);
+    size_t len = strlen(word);
+    const char* characters[len + 1];
+    int lengths[len + 1];
+    int nbCharacters = 0;
+    for (size_t i = 0; i < len; ) {
+        int n = characterLength((unsigned char)word[i]);
+        if (i + n > len) n = len - i;
+        characters[nbCharacters] = word + i;
+        lengths[nbCharacters++] = n;
+        i += n;
+    }
+
+    // Tri par insertion : les mots sont courts
+    for (int i = 1; i < nbCharacters; i++) {
+        const char* character = characters[i];
+        int n = lengths[i];
+        int j = i - 1;
+        while (j >= 0) {
+            int common = lengths[j] < n ? lengths[j] : n;
+            int order = memcmp(characters[j], character, common);
+            if (order < 0 || (order == 0 && lengths[j] <= n)) break;
+            characters[j + 1] = characters[j];
+            lengths[j + 1] = lengths[j];
+            j--;
+        }
+        characters[j + 1] = character;
+        lengths[j + 1] = n;
+    }
+
+    char* out = signature;
+    for (int i = 0; i < nbCharacters; i++) {
+        memcpy(out, characters[i], lengths[i]);
+        out += lengths[i];
+    }
+    *out = '\0';
+}
+
+// Hachage d'une signature (h = 33 * h + c, h0 = 5381)
+unsigned int hashSignature(const char* signature, int nbSlots) {
+    unsigned int hash = 5381;
+    while (*signature) {
+        hash = ((hash << 5) + hash) + (unsigned char)*signature++;
+    }
+    return hash % nbSlots;
+}
+
+// Création d'un index vide
+t_anagramIndex* createIndex(void) {
+    t_anagramIndex* index = malloc(sizeof(t_anagramIndex));
+    assert(index != NULL);
+    index->nbSlots = INITIAL_NB_SLOTS;
+    index->slots = calloc(index->nbSlots, sizeof(t_group*));
+    assert(index->slots != NULL);
+    index->nbGroups = 0;
+    index->nbWords = 0;
+    index->groupsCapacity = 1024;
+    index->groups = malloc(index->groupsCapacity * sizeof(t_group*));
+    assert(index->groups != NULL);
+    index->wordsCapacity = 1024;
+    index->words = malloc(index->wordsCapacity * sizeof(char*));
+    assert(index->words != NULL);
+    index->arena = createArena();
+    return index;
+}
+
+// Groupe d'une signature (NULL s'il n'existe pas) ; probes reçoit le nombre
+// de groupes examinés dans l'alvéole
+t_group* findGroup(t_anagramIndex* index, const char* signature, int* probes) {
+    *probes = 0;
+    for (t_group* group = index->slots[hashSignature(signature, index->nbSlots)]; group; group = group->next) {
+        (*probes)++;
+        if (strcmp(group->signature, signature) == 0) return group;
+    }
+    return NULL;
+}
+
+// Doublement du nombre d'alvéoles et redistribution des groupes
+void growIndex(t_anagramIndex* index) {
+    int nbSlots = index->nbSlots * 2;
+    t_group** slots = calloc(nbSlots, sizeof(t_group*));
+    assert(slots != NULL);
+    for (int i = 0; i < index->nbSlots; i++) {
+        t_group* group = index->slots[i];
+        while (group) {
+            t_group* next = group->next;
+            unsigned int slot = hashSignature(group->signature, nbSlots);
+            group->next = slots[slot];
+            slots[slot] = group;
+            group = next;
+        }
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->nbSlots = nbSlots;
+}
+
+// Ajout d'un mot à son groupe (créé au besoin) ; un mot déjà présent est ignoré
+void addWord(t_anagramIndex* index, const char* word) {
+    char signature[2 * strlen(word) + 1];
+    computeSignature(word, signature);
+
+    int probes;
+    t_group* group = findGroup(index, signature, &probes);
+    if (group) {
+        for (int i = 0; i < group->nbWords; i++) {
+            if (strcmp(group->words[i], word) == 0) return;
+        }
+    } else {
+        if (index->nbGroups + 1 > index->nbSlots) growIndex(index);
+        group = arenaAlloc(index->arena, sizeof(t_group));
+        group->signature = arenaCopy(index->arena, signature, strlen(signature));
+        group->capacity = 2;
+        group->words = arenaAlloc(index->arena, group->capacity * sizeof(char*));
+        group->nbWords = 0;
+        unsigned int slot = hashSignature(signature, index->nbSlots);
+        group->next = index->slots[slot];
+        index->slots[slot] = group;
+
+        if (index->nbGroups >= index->groupsCapacity) {
+            index->groupsCapacity *= 2;
+            index->groups = realloc(index->groups, index->groupsCapacity * sizeof(t_group*));
+            assert(index->groups != NULL);
+        }
+        index->groups[index->nbGroups++] = group;
+    }
+
+    // Tableau de mots du groupe : doublé dans l'arène quand il est plein
+    if (group->nbWords == group->capacity) {
+        char** words = arenaAlloc(index->arena, 2 * group->capacity * sizeof(char*));
+        memcpy(words, group->words, group->nbWords * sizeof(char*));
+        group->words = words;
+        group->capacity *= 2;
+    }
+    char* copy = arenaCopy(index->arena, word, strlen(word));
+    group->words[group->nbWords++] = copy;
+
+    if (index->nbWords >= index->wordsCapacity) {
+        index->wordsCapacity *= 2;
+        index->words = realloc(index->words, index->wordsCapacity * sizeof(char*));
+        assert(index->words != NULL);
+    }
+    index->words[index->nbWords++] = copy;
+}
+
+// Chargement d'une liste de mots (un par ligne, lignes vides ignorées)
+t_anagramIndex* loadWordList(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Erreur d'ouverture de la liste de mots");
+        exit(EXIT_FAILURE);
+    }
+    t_anagramIndex* index = createIndex();
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = readLine(file, &line, &capacity)) >= 0) {
+        if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+        if (len > 0) addWord(index, line);
+    }
+    free(line);
+    fclose(file);
+    return index;
+}
+
+// Affichage des anagrammes d'un mot (le mot lui-même exclu, quelle que soit
+// la forme de ses accents)
+void searchAnagrams(t_anagramIndex* index, const char* word) {
+    char signature[2 * strlen(word) + 1];
+    char decomposed[2 * strlen(word) + 1];
+    computeSignature(word, signature);
+    decomposeWord(word, decomposed);
+
+    int probes;
+    t_group* group = findGroup(index, signature, &probes);
+    int nbAnagrams = 0;
+    printf("Anagrammes de %s :", word);
+    for (int i = 0; group && i < group->nbWords; i++) {
+        if (strcmp(group->words[i], decomposed) != 0) {
+            printf("%s %s", nbAnagrams > 0 ? "," : "", group->words[i]);
+            nbAnagrams++;
+        }
+    }
+    printf("%s (%d trouvé%s, nb sondages : %d)\n", nbAnagrams == 0 ? " aucun" : "", nbAnagrams, nbAnagrams > 1 ? "s" : "", probes);
+}
+
+// Ordre des groupes cités en commentaire : taille croissante, puis premier mot
+int compareListedGroups(const void* a, const void* b) {
+    const t_group* groupA = *(t_group* const*)a;
+    const t_group* groupB = *(t_group* const*)b;
+    if (groupA->nbWords != groupB->nbWords) return groupA->nbWords - groupB->nbWords;
+    return strcmp(groupA->words[0], groupB->words[0]);
+}
+
+// Écriture de la table des anagrammes au format des fichiers de Tables :
+// commentaires (plus grands groupes), séparateur, nombre de champs, noms des
+// champs, puis une ligne par mot ayant au moins un anagramme, dans l'ordre de la liste
+void generateTable(t_anagramIndex* index, FILE* output) {
+    char sep = ':';
+    int maxWords = 0;
+    int nbListed = 0;
+    t_group** listed = malloc((index->nbGroups + 1) * sizeof(t_group*));
+    assert(listed != NULL);
+    for (int i = 0; i < index->nbGroups; i++) {
+        t_group* group = index->groups[i];
+        if (group->nbWords > maxWords) maxWords = group->nbWords;
+        if (group->nbWords >= MIN_LISTED_GROUP) listed[nbListed++] = group;
+    }
+    qsort(listed, nbListed, sizeof(t_group*), compareListedGroups);
+
+    fprintf(output, "# Mots comportant le plus grand nombres d'anagrammes : \n");
+    for (int i = 0; i < nbListed; i++) {
+        fprintf(output, "#%d : ", listed[i]->nbWords);
+        for (int j = 0; j < listed[i]->nbWords; j++) {
+            fprintf(output, "%s%c", listed[i]->words[j], j == listed[i]->nbWords - 1 ? '\n' : sep);
+        }
+    }
+    free(listed);
+
+    // Autant de champs d'anagrammes que de mots dans le plus grand groupe
+    // (un de plus que nécessaire, comme dans la table d'origine)
+    fprintf(output, "%c\n%d\nmot", sep, maxWords + 1);
+    for (int i = 1; i <= maxWords; i++) {
+        fprintf(output, "%canagramme %d", sep, i);
+    }
+    fprintf(output, "\n");
+
+    for (int w = 0; w < index->nbWords; w++) {
+        const char* word = index->words[w];
+        char signature[2 * strlen(word) + 1];
+        computeSignature(word, signature);
+        int probes;
+        t_group* group = findGroup(index, signature, &probes);
+        if (group->nbWords < 2) continue;
+        fprintf(output, "%s", word);
+        for (int i = 0; i < group->nbWords; i++) {
+            if (group->words[i] != word) fprintf(output, "%c%s", sep, group->words[i]);
+        }
+        fprintf(output, "\n");
+    }
+}
+
+// Libération de l'index
+void freeIndex(t_anagramIndex* index) {
+    freeArena(index->arena);
+    free(index->slots);
+    free(index->groups);
+    free(index->words);
+    free(index);
+}
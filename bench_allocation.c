@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "fr_commun.h"
+
+// Comparaison des temps de chargement et de libération d'une table de hachage
+// (même construction que programme2) selon l'allocateur utilisé :
+//  - malloc : un malloc par clé, par champ et par tableau, libérés un par un
+//  - arène  : tout est alloué à la suite dans de grands blocs, libérés en une fois
+
+#define NB_SLOTS 65536
+
+// Structures
+typedef struct {
+    char* key;
+    char*** definitions;
+    int nbDefinitions;
+} t_tuple;
+
+typedef struct node {
+    t_tuple data;
+    struct node* next;
+} t_node;
+
+typedef struct {
+    t_node** slots;
+    int nbSlots;
+    int nbTuples;
+    int nbFields;
+    t_arena* arena;  // NULL : allocation champ par champ avec malloc
+} t_hashtable;
+
+// Prototypes
+double now(void);
+void* tableAlloc(t_hashtable* table, size_t size);
+char* allocateField(t_hashtable* table, const char* source);
+unsigned int hashFunction2(const char* key, int nbSlots);
+t_hashtable* loadTable(const char* filename, int useArena);
+void insertTupleHash(t_hashtable* table, char* key, char** definition);
+void freeHashTable(t_hashtable* table);
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <filename> [nbRépétitions]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    const char* filename = argv[1];
+    int repetitions = argc > 2 ? atoi(argv[2]) : 5;
+    if (repetitions <= 0) {
+        fprintf(stderr, "Erreur : nombre de répétitions invalide.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s %16s %16s %8s\n", "allocateur", "chargement (ms)", "libération (ms)", "mots");
+    for (int useArena = 0; useArena <= 1; useArena++) {
+        double load = 0, release = 0;
+        int nbTuples = 0;
+        for (int r = 0; r < repetitions; r++) {
+            double start = now();
+            t_hashtable* table = loadTable(filename, useArena);
+            double loaded = now();
+            nbTuples = table->nbTuples;
+            freeHashTable(table);
+            double freed = now();
+            load += loaded - start;
+            release += freed - loaded;
+        }
+        printf("%-10s %16.2f %16.2f %8d\n", useArena ? "arène" : "malloc",
+            1000 * load / repetitions, 1000 * release / repetitions, nbTuples);
+    }
+    return 0;
+}
+
+// Horloge monotone en secondes
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Allocation selon l'allocateur de la table
+void* tableAlloc(t_hashtable* table, size_t size) {
+    if (table->arena) return arenaAlloc(table->arena, size);
+    void* ptr = malloc(size);
+    assert(ptr != NULL);
+    return ptr;
+}
+
+// Copie d'un champ
+char* allocateField(t_hashtable* table, const char* source) {
+    size_t len = strlen(source);
+    char* field = tableAlloc(table, len + 1);
+    memcpy(field, source, len + 1);
+    return field;
+}
+
+// Fonction de hachage 2
+unsigned int hashFunction2(const char* key, int nbSlots) {
+    unsigned int hash = 5381;
+    while (*key) {
+        hash = ((hash << 5) + hash) + *key++;
+    }
+    return hash % nbSlots;
+}
+
+// Chargement du fichier (séparateur, nombre de champs, noms, données)
+t_hashtable* loadTable(const char* filename, int useArena) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Erreur d'ouverture de fichier");
+        exit(EXIT_FAILURE);
+    }
+
+    t_hashtable* table = malloc(sizeof(t_hashtable));
+    assert(table != NULL);
+    table->slots = calloc(NB_SLOTS, sizeof(t_node*));
+    assert(table->slots != NULL);
+    table->nbSlots = NB_SLOTS;
+    table->nbTuples = 0;
+    table->nbFields = 0;
+    table->arena = useArena ? createArena() : NULL;
+
+    char sep = '\0';
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    int step = 0;
+    while ((len = readLine(file, &line, &capacity)) >= 0) {
+        if (line[0] == '#' && len > 1) {
+            continue;
+        }
+        if (step == 0) {
+            sep = line[0];
+        } else if (step == 1) {
+            table->nbFields = atoi(line);
+            if (table->nbFields <= 0) {
+                fprintf(stderr, "Erreur : nombre de champs invalide : %s\n", line);
+                exit(EXIT_FAILURE);
+            }
+        } else if (step >= 3) {
+            char* fields[table->nbFields];
+            splitFields(line, len, sep, fields, table->nbFields);
+            if (fields[0][0] != '\0') {
+                char* key = allocateField(table, fields[0]);
+                char** definition = tableAlloc(table, (table->nbFields - 1) * sizeof(char*));
+                for (int i = 0; i < table->nbFields - 1; i++) {
+                    definition[i] = allocateField(table, fields[i + 1]);
+                }
+                insertTupleHash(table, key, definition);
+            }
+        }
+        if (step < 3) step++;
+    }
+    free(line);
+    fclose(file);
+    return table;
+}
+
+// Insertion (la table devient propriétaire de key et definition)
+void insertTupleHash(t_hashtable* table, char* key, char** definition) {
+    unsigned int index = hashFunction2(key, table->nbSlots);
+    for (t_node* current = table->slots[index]; current; current = current->next) {
+        if (strcmp(current->data.key, key) == 0) {
+            char*** definitions = tableAlloc(table, (current->data.nbDefinitions + 1) * sizeof(char**));
+            memcpy(definitions, current->data.definitions, current->data.nbDefinitions * sizeof(char**));
+            definitions[current->data.nbDefinitions] = definition;
+            if (!table->arena) free(current->data.definitions);
+            current->data.definitions = definitions;
+            current->data.nbDefinitions++;
+            if (!table->arena) free(key);
+            return;
+        }
+    }
+    t_node* newNode = tableAlloc(table, sizeof(t_node));
+    newNode->data.key = key;
+    newNode->data.definitions = tableAlloc(table, sizeof(char**));
+    newNode->data.definitions[0] = definition;
+    newNode->data.nbDefinitions = 1;
+    newNode->next = table->slots[index];
+    table->slots[index] = newNode;
+    table->nbTuples++;
+}
+
+// Libération : champ par champ avec malloc, en un appel avec l'arène
+void freeHashTable(t_hashtable* table) {
+    if (table->arena) {
+        freeArena(table->arena);
+    } else {
+        for (int i = 0; i < table->nbSlots; i++) {
+            t_node* current = table->slots[i];
+            while (current) {
+                t_node* temp = current;
+                free(current->data.key);
+                for (int d = 0; d < current->data.nbDefinitions; d++) {
+                    for (int j = 0; j < table->nbFields - 1; j++) {
+                        free(current->data.definitions[d][j]);
+                    }
+                    free(current->data.definitions[d]);
+                }
+                free(current->data.definitions);
+                current = current->next;
+                free(temp);
+            }
+        }
+    }
+    free(table->slots);
+    free(table);
+}
@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "fr_protocole.h"
+
+// Client du serveur de recherche, de deux façons :
+//  - sans -q, recherche des mots saisis et affichage des définitions reçues ;
+//  - avec -q, générateur de charge : c connexions envoient en boucle les mots
+//    du fichier pendant d secondes, chacune gardant p requêtes en vol
+//    (pipeline), puis débit soutenu et centiles de latence.
+
+#define MAX_CONNECTIONS 256
+#define MAX_DEPTH 1024
+#define READ_SIZE (64 * 1024)
+
+// Structures
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} t_buffer;
+
+// Une connexion du générateur de charge et ses mesures
+typedef struct {
+    const char* socketPath;
+    char** queries;
+    int nbQueries;
+    int offset;           // Première requête envoyée (les connexions ne partent pas du même mot)
+    int depth;            // Requêtes en vol
+    double duration;
+    int table;
+    int op;
+    long nbResponses;
+    long found;
+    long errors;
+    double* latencies;    // Une par réponse, en secondes
+    long capacity;
+    int failed;
+} t_loader;
+
+// Prototypes
+double now(void);
+int connectSocket(const char* socketPath);
+void* reserve(t_buffer* buffer, size_t size);
+int receive(int fd, t_buffer* input);
+size_t responseSize(const t_buffer* input, size_t pos);
+int readResponse(int fd, t_buffer* input, size_t* consumed, t_frResponse* response, const char** payload);
+void appendRequest(t_buffer* output, int table, int op, const char* key, size_t len);
+int writeAll(int fd, const char* data, size_t size);
+char** readQueries(const char* filename, char** text, int* nbQueries);
+int compareDoubles(const void* a, const void* b);
+void* loadWorker(void* arg);
+int runLoad(const char* socketPath, char** queries, int nbQueries, int nbConnections, int depth, double duration, int table, int op);
+int runInteractive(const char* socketPath, int table);
+
+int main(int argc, char* argv[]) {
+    const char* socketPath = NULL;
+    const char* queryFile = NULL;
+    int table = 0;
+    int nbConnections = 1;
+    int depth = 1;
+    double duration = 5;
+    int op = FR_OP_RECHERCHE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-s", 2) == 0) {
+            socketPath = argv[i] + 2;
+        } else if (strncmp(argv[i], "-t", 2) == 0) {
+            table = atoi(argv[i] + 2);
+            if (table < 0 || table > UINT8_MAX) {
+                fprintf(stderr, "Erreur : numéro de table invalide (0 à %d).\n", UINT8_MAX);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-q", 2) == 0) {
+            queryFile = argv[i] + 2;
+        } else if (strncmp(argv[i], "-c", 2) == 0) {
+            nbConnections = atoi(argv[i] + 2);
+            if (nbConnections <= 0 || nbConnections > MAX_CONNECTIONS) {
+                fprintf(stderr, "Erreur : nombre de connexions invalide (1 à %d).\n", MAX_CONNECTIONS);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-p", 2) == 0) {
+            depth = atoi(argv[i] + 2);
+            if (depth <= 0 || depth > MAX_DEPTH) {
+                fprintf(stderr, "Erreur : profondeur de pipeline invalide (1 à %d).\n", MAX_DEPTH);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-d", 2) == 0) {
+            duration = atof(argv[i] + 2);
+            if (duration <= 0) {
+                fprintf(stderr, "Erreur : durée invalide.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-e") == 0) {
+            op = FR_OP_EXISTE;
+        } else {
+            fprintf(stderr, "Erreur : argument inconnu %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!socketPath) {
+        fprintf(stderr, "Usage: %s -s<chemin de la socket> [-t<table>] [-q<fichier requêtes> [-c<connexions>] [-p<pipeline>] [-d<durée>] [-e]]\n", argv[0]);
+        fprintf(stderr, "  sans -q, recherche les mots saisis dans la table -t (0 par défaut)\n");
+        fprintf(stderr, "  -q envoie en boucle les mots du fichier pendant -d secondes (5 par défaut) sur -c connexions,\n");
+        fprintf(stderr, "     -p requêtes en vol par connexion, puis affiche le débit et les centiles de latence\n");
+        fprintf(stderr, "  -e ne demande que la présence des mots (pas les définitions)\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!queryFile) return runInteractive(socketPath, table);
+
+    char* text;
+    int nbQueries;
+    char** queries = readQueries(queryFile, &text, &nbQueries);
+    if (nbQueries == 0) {
+        fprintf(stderr, "Erreur : aucune requête dans %s.\n", queryFile);
+        return EXIT_FAILURE;
+    }
+    int status = runLoad(socketPath, queries, nbQueries, nbConnections, depth, duration, table, op);
+    free(queries);
+    free(text);
+    return status;
+}
+
+// Horloge monotone en secondes
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Connexion à la socket du serveur ; -1 en cas d'échec (message affiché)
+int connectSocket(const char* socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Erreur : chemin de socket trop long.\n");
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        perror("Erreur de connexion au serveur");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Place pour size octets à la fin du tampon (agrandi au besoin), comptés dans sa taille
+void* reserve(t_buffer* buffer, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : READ_SIZE;
+        while (buffer->size + size > capacity) capacity *= 2;
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != NULL);
+        buffer->capacity = capacity;
+    }
+    void* ptr = buffer->data + buffer->size;
+    buffer->size += size;
+    return ptr;
+}
+
+// Lecture de ce qui est disponible à la suite du tampon ; -1 si le serveur a fermé
+int receive(int fd, t_buffer* input) {
+    for (;;) {
+        char* end = reserve(input, READ_SIZE);
+        input->size -= READ_SIZE;
+        ssize_t count = read(fd, end, READ_SIZE);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return -1;
+        input->size += count;
+        return 0;
+    }
+}
+
+// Taille de la réponse complète qui commence en pos, 0 si elle n'est pas encore toute reçue
+size_t responseSize(const t_buffer* input, size_t pos) {
+    t_frResponse response;
+    if (input->size - pos < sizeof(response)) return 0;
+    memcpy(&response, input->data + pos, sizeof(response));
+    if (input->size - pos < sizeof(response) + response.size) return 0;
+    return sizeof(response) + response.size;
+}
+
+// Attente de la prochaine réponse : les *consumed octets de la réponse
+// précédente sont d'abord retirés du tampon, puis *consumed reçoit la taille
+// de la nouvelle, laissée en tête du tampon jusqu'à l'appel suivant
+int readResponse(int fd, t_buffer* input, size_t* consumed, t_frResponse* response, const char** payload) {
+    if (*consumed > 0) {
+        memmove(input->data, input->data + *consumed, input->size - *consumed);
+        input->size -= *consumed;
+        *consumed = 0;
+    }
+    size_t size;
+    while ((size = responseSize(input, 0)) == 0) {
+        if (receive(fd, input) < 0) return -1;
+    }
+    memcpy(response, input->data, sizeof(*response));
+    *payload = input->data + sizeof(*response);
+    *consumed = size;
+    return 0;
+}
+
+// Requête à la suite du tampon de sortie
+void appendRequest(t_buffer* output, int table, int op, const char* key, size_t len) {
+    t_frRequest request = { (uint16_t)len, (uint8_t)table, (uint8_t)op };
+    memcpy(reserve(output, sizeof(request)), &request, sizeof(request));
+    memcpy(reserve(output, len), key, len);
+}
+
+// Écriture complète (write peut n'en écrire qu'une partie)
+int writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return -1;
+        data += count;
+        size -= count;
+    }
+    return 0;
+}
+
+// Lecture d'un fichier de requêtes (un mot par ligne, lignes vides et mots de
+// plus de 65535 octets ignorés) : le fichier est lu d'un bloc dans *text (à
+// libérer avec le tableau renvoyé) et découpé sur place
+char** readQueries(const char* filename, char** text, int* nbQueries) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Erreur d'ouverture du fichier de requêtes");
+        exit(EXIT_FAILURE);
+    }
+    size_t size = 0, capacity = 64 * 1024;
+    *text = malloc(capacity + 1);
+    assert(*text != NULL);
+    size_t count;
+    while ((count = fread(*text + size, 1, capacity - size, file)) > 0) {
+        size += count;
+        if (size == capacity) {
+            capacity *= 2;
+            *text = realloc(*text, capacity + 1);
+            assert(*text != NULL);
+        }
+    }
+    fclose(file);
+    (*text)[size] = '\0';
+
+    int maxQueries = 1024;
+    char** queries = malloc(maxQueries * sizeof(char*));
+    assert(queries != NULL);
+    *nbQueries = 0;
+    for (char* line = *text; line < *text + size; ) {
+        char* end = memchr(line, '\n', *text + size - line);
+        if (!end) end = *text + size;
+        *end = '\0';
+        if (end > line && end - line <= UINT16_MAX) {
+            if (*nbQueries >= maxQueries) {
+                maxQueries *= 2;
+                queries = realloc(queries, maxQueries * sizeof(char*));
+                assert(queries != NULL);
+            }
+            queries[(*nbQueries)++] = line;
+        }
+        line = end + 1;
+    }
+    return queries;
+}
+
+// Ordre croissant de deux durées (tri des latences)
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Thread d'une connexion : depth requêtes en vol, chaque paquet de réponses
+// reçu est aussitôt remplacé par autant de nouvelles requêtes, écrites en une
+// fois. La latence d'une requête va de l'écriture de son paquet à la lecture
+// du paquet qui contient sa réponse. Plus d'envoi après duration secondes,
+// les réponses en vol sont attendues.
+void* loadWorker(void* arg) {
+    t_loader* loader = arg;
+    int fd = connectSocket(loader->socketPath);
+    if (fd < 0) {
+        loader->failed = 1;
+        return NULL;
+    }
+    double sent[MAX_DEPTH];   // Instant d'envoi de la requête n, en sent[n % depth]
+    t_buffer input = { NULL, 0, 0 };
+    t_buffer output = { NULL, 0, 0 };
+    long nextSend = 0, nextReceive = 0;
+    double end = now() + loader->duration;
+
+    for (;;) {
+        // Compléter le pipeline (horloge lue une fois par tour : plus rien
+        // n'est envoyé après l'échéance, on attend seulement les réponses en vol)
+        int sending = now() < end;
+        if (sending && nextSend - nextReceive < loader->depth) {
+            output.size = 0;
+            long first = nextSend;
+            while (nextSend - nextReceive < loader->depth) {
+                const char* key = loader->queries[(loader->offset + nextSend) % loader->nbQueries];
+                appendRequest(&output, loader->table, loader->op, key, strlen(key));
+                nextSend++;
+            }
+            double start = now();
+            for (long n = first; n < nextSend; n++) sent[n % loader->depth] = start;
+            if (writeAll(fd, output.data, output.size) < 0) {
+                loader->failed = 1;
+                break;
+            }
+        }
+
+        if (nextReceive == nextSend) break;
+
+        // Réponses arrivées
+        if (receive(fd, &input) < 0) {
+            loader->failed = 1;
+            break;
+        }
+        double arrival = now();
+        size_t pos = 0, size;
+        while ((size = responseSize(&input, pos)) > 0) {
+            t_frResponse response;
+            memcpy(&response, input.data + pos, sizeof(response));
+            if (response.status == FR_TROUVE) loader->found++;
+            if (response.status == FR_ERREUR) loader->errors++;
+            if (loader->nbResponses == loader->capacity) {
+                loader->capacity = loader->capacity ? 2 * loader->capacity : 1 << 16;
+                loader->latencies = realloc(loader->latencies, loader->capacity * sizeof(double));
+                assert(loader->latencies != NULL);
+            }
+            loader->latencies[loader->nbResponses++] = arrival - sent[nextReceive % loader->depth];
+            nextReceive++;
+            pos += size;
+        }
+        memmove(input.data, input.data + pos, input.size - pos);
+        input.size -= pos;
+    }
+
+    close(fd);
+    free(input.data);
+    free(output.data);
+    return NULL;
+}
+
+// Générateur de charge : une connexion par thread, puis bilan sur toutes les réponses
+int runLoad(const char* socketPath, char** queries, int nbQueries, int nbConnections, int depth, double duration, int table, int op) {
+    t_loader loaders[MAX_CONNECTIONS];
+    pthread_t threads[MAX_CONNECTIONS];
+    double start = now();
+    for (int c = 0; c < nbConnections; c++) {
+        t_loader loader = { socketPath, queries, nbQueries, (int)((long)nbQueries * c / nbConnections), depth, duration,
+            table, op, 0, 0, 0, NULL, 0, 0 };
+        loaders[c] = loader;
+        pthread_create(&threads[c], NULL, loadWorker, &loaders[c]);
+    }
+    long nbResponses = 0, found = 0, errors = 0;
+    int failed = 0;
+    for (int c = 0; c < nbConnections; c++) {
+        pthread_join(threads[c], NULL);
+        nbResponses += loaders[c].nbResponses;
+        found += loaders[c].found;
+        errors += loaders[c].errors;
+        failed |= loaders[c].failed;
+    }
+    double elapsed = now() - start;
+    if (failed) fprintf(stderr, "Erreur : connexion au serveur perdue.\n");
+
+    // Toutes les latences ensemble pour les centiles
+    double* latencies = malloc((nbResponses + 1) * sizeof(double));
+    assert(latencies != NULL);
+    long n = 0;
+    double total = 0;
+    for (int c = 0; c < nbConnections; c++) {
+        for (long r = 0; r < loaders[c].nbResponses; r++) {
+            total += loaders[c].latencies[r];
+            latencies[n++] = loaders[c].latencies[r];
+        }
+        free(loaders[c].latencies);
+    }
+    qsort(latencies, n, sizeof(double), compareDoubles);
+
+    printf("%d connexions, pipeline %d, %.2f s : %ld requêtes, %.0f requêtes/s\n",
+        nbConnections, depth, elapsed, nbResponses, elapsed > 0 ? nbResponses / elapsed : 0);
+    printf("  trouvés : %ld, absents : %ld, erreurs : %ld\n", found, nbResponses - found - errors, errors);
+    if (n > 0) {
+        printf("  latence : moyenne %.1f us, p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+            total * 1e6 / n, latencies[n / 2] * 1e6, latencies[(long)(n * 0.9)] * 1e6,
+            latencies[(long)(n * 0.99)] * 1e6, latencies[(long)(n * 0.999)] * 1e6, latencies[n - 1] * 1e6);
+    }
+    free(latencies);
+    return failed || errors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Recherche des mots saisis : noms des champs demandés une fois, puis une
+// requête par mot et affichage des définitions reçues
+int runInteractive(const char* socketPath, int table) {
+    int fd = connectSocket(socketPath);
+    if (fd < 0) return EXIT_FAILURE;
+    t_buffer input = { NULL, 0, 0 };
+    t_buffer output = { NULL, 0, 0 };
+    size_t consumed = 0;
+    t_frResponse response;
+    const char* payload;
+
+    // Noms des champs, clé comprise
+    appendRequest(&output, table, FR_OP_CHAMPS, "", 0);
+    if (writeAll(fd, output.data, output.size) < 0 || readResponse(fd, &input, &consumed, &response, &payload) < 0) {
+        fprintf(stderr, "Erreur : connexion au serveur perdue.\n");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    if (response.status != FR_TROUVE) {
+        fprintf(stderr, "Erreur : table %d inconnue du serveur.\n", table);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    int nbFields = response.nbFields;
+    char* names = malloc(response.size + 1);
+    assert(names != NULL);
+    char* fieldNames[nbFields];
+    const char* field = payload;
+    char* name = names;
+    for (int j = 0; j < nbFields; j++) {
+        uint32_t len;
+        memcpy(&len, field, sizeof(len));
+        memcpy(name, field + sizeof(len), len);
+        name[len] = '\0';
+        fieldNames[j] = name;
+        name += len + 1;
+        field += sizeof(len) + len;
+    }
+
+    printf("Saisir les mots recherchés :\n\n");
+    char key[1000];
+    int status = EXIT_SUCCESS;
+    while (fgets(key, sizeof(key), stdin)) {
+        size_t len = strlen(key);
+        if (len > 0 && key[len - 1] == '\n') key[--len] = '\0';
+        if (len == 0) break;
+        output.size = 0;
+        appendRequest(&output, table, FR_OP_RECHERCHE, key, len);
+        if (writeAll(fd, output.data, output.size) < 0 || readResponse(fd, &input, &consumed, &response, &payload) < 0) {
+            fprintf(stderr, "Erreur : connexion au serveur perdue.\n");
+            status = EXIT_FAILURE;
+            break;
+        }
+        if (response.status != FR_TROUVE) {
+            printf("Recherche de %s : échec !\n", key);
+            continue;
+        }
+        printf("Recherche de %s : trouvé !\n", key);
+        printf("mot : %s\n", key);
+        field = payload;
+        for (uint32_t d = 0; d < response.nbDefinitions; d++) {
+            printf("Définition %u :\n", d + 1);
+            for (int j = 1; j < nbFields; j++) {
+                uint32_t fieldLen;
+                memcpy(&fieldLen, field, sizeof(fieldLen));
+                printf("  %s : %.*s\n", fieldNames[j], fieldLen > 0 ? (int)fieldLen : 1, fieldLen > 0 ? field + sizeof(fieldLen) : "X");
+                field += sizeof(fieldLen) + fieldLen;
+            }
+            printf("\n");
+        }
+    }
+
+    close(fd);
+    free(names);
+    free(input.data);
+    free(output.data);
+    return status;
+}
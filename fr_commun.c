@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "fr_commun.h"
+
+// Création d'une arène vide
+t_arena* createArena(void) {
+    t_arena* arena = malloc(sizeof(t_arena));
+    assert(arena != NULL);
+    arena->head = NULL;
+    arena->allocated = 0;
+    return arena;
+}
+
+// Allocation dans l'arène (alignée sur 8 octets)
+void* arenaAlloc(t_arena* arena, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    t_arenaBlock* block = arena->head;
+    if (block == NULL || block->used + size > block->size) {
+        size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(t_arenaBlock) + blockSize);
+        assert(block != NULL);
+        block->next = arena->head;
+        block->used = 0;
+        block->size = blockSize;
+        arena->head = block;
+    }
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->allocated += size;
+    return ptr;
+}
+
+// Copie de len octets dans l'arène, terminée par '\0'
+char* arenaCopy(t_arena* arena, const char* source, size_t len) {
+    char* copy = arenaAlloc(arena, len + 1);
+    memcpy(copy, source, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+// Rattachement des blocs de other à arena (other est libérée, pas ses blocs).
+// Les blocs sont insérés derrière le bloc courant, qui reste celui où l'on alloue.
+void mergeArena(t_arena* arena, t_arena* other) {
+    if (other->head) {
+        t_arenaBlock* last = other->head;
+        while (last->next) last = last->next;
+        if (arena->head) {
+            last->next = arena->head->next;
+            arena->head->next = other->head;
+        } else {
+            arena->head = other->head;
+        }
+    }
+    arena->allocated += other->allocated;
+    free(other);
+}
+
+// Libération de l'arène et de tout ce qu'elle contient
+void freeArena(t_arena* arena) {
+    t_arenaBlock* block = arena->head;
+    while (block) {
+        t_arenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+// Lecture d'une ligne de longueur quelconque dans *line, tampon agrandi au
+// besoin et réutilisé d'une ligne à l'autre (aucune allocation par ligne ;
+// le libérer après la dernière lecture). Le '\n' final est retiré.
+// Renvoie la longueur de la ligne, ou -1 en fin de fichier.
+ssize_t readLine(FILE* file, char** line, size_t* capacity) {
+    ssize_t len = getline(line, capacity, file);
+    if (len > 0 && (*line)[len - 1] == '\n') (*line)[--len] = '\0';
+    return len;
+}
+
+// Découpage de line (len octets) en au plus nbFields champs, en un seul
+// parcours : memchr saute d'un séparateur au suivant, qui est remplacé par '\0'.
+// Contrairement à strtok, les champs vides sont conservés (deux séparateurs
+// consécutifs délimitent un champ vide) et aucun état n'est gardé entre deux
+// appels : plusieurs threads peuvent découper leurs lignes en même temps.
+// Les champs absents pointent sur une chaîne vide. Renvoie le nombre de champs trouvés.
+int splitFields(char* line, size_t len, char sep, char** fields, int nbFields) {
+    char* end = line + len;
+    char* pos = line;
+    int count = 0;
+    while (count < nbFields) {
+        char* next = memchr(pos, sep, end - pos);
+        fields[count++] = pos;
+        if (!next) break;
+        *next = '\0';
+        pos = next + 1;
+    }
+    for (int i = count; i < nbFields; i++) {
+        fields[i] = end;
+    }
+    return count;
+}
@@ -0,0 +1,38 @@
+#ifndef FR_COMMUN_H
+#define FR_COMMUN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Outils communs aux programmes et à la bibliothèque fr_table : arène,
+// lecture de lignes et découpage des champs. Usage interne : ils ne font pas
+// partie de l'interface de fr_table.h. Compilés dans libfr_table.a.
+
+// Arène : blocs chaînés dans lesquels les chaînes et tableaux d'une table
+// sont alloués les uns à la suite des autres, puis libérés d'un seul coup
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct arenaBlock {
+    struct arenaBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} t_arenaBlock;
+
+typedef struct {
+    t_arenaBlock* head; // Bloc courant (les précédents suivent via next)
+    size_t allocated;   // Octets demandés depuis la création
+} t_arena;
+
+t_arena* createArena(void);
+void* arenaAlloc(t_arena* arena, size_t size);
+char* arenaCopy(t_arena* arena, const char* source, size_t len);
+void mergeArena(t_arena* arena, t_arena* other);
+void freeArena(t_arena* arena);
+
+// Lecture et découpage des lignes
+ssize_t readLine(FILE* file, char** line, size_t* capacity);
+int splitFields(char* line, size_t len, char sep, char** fields, int nbFields);
+
+#endif
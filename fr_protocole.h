@@ -0,0 +1,39 @@
+#ifndef FR_PROTOCOLE_H
+#define FR_PROTOCOLE_H
+
+#include <stdint.h>
+
+// Protocole entre serveur et client (socket Unix locale, entiers dans l'ordre
+// des octets de la machine). Un client envoie autant de requêtes qu'il veut sans
+// attendre (pipeline) : les réponses arrivent dans l'ordre des requêtes.
+//
+// Requête : t_frRequest puis keyLen octets de clé (sans '\0').
+// Réponse : t_frResponse puis size octets. Pour une clé trouvée
+// (FR_OP_RECHERCHE), nbDefinitions définitions de nbFields - 1 champs, chaque
+// champ étant une longueur uint32_t suivie de ses octets (longueur 0 : champ
+// vide). FR_OP_CHAMPS renvoie de même une « définition » des nbFields noms de
+// champs, clé comprise ; FR_OP_EXISTE ne renvoie que l'état.
+
+#define FR_OP_RECHERCHE 1   // Définitions d'une clé
+#define FR_OP_EXISTE    2   // Présence d'une clé seulement
+#define FR_OP_CHAMPS    3   // Noms des champs de la table (clé ignorée)
+
+#define FR_TROUVE  0
+#define FR_ABSENT  1
+#define FR_ERREUR  2        // Table ou opération inconnue
+
+typedef struct {
+    uint16_t keyLen;
+    uint8_t table;          // Indice de la table dans l'ordre de chargement du serveur
+    uint8_t op;
+} t_frRequest;
+
+typedef struct {
+    uint32_t size;          // Octets qui suivent l'en-tête
+    uint8_t status;
+    uint8_t unused;
+    uint16_t nbFields;
+    uint32_t nbDefinitions;
+} t_frResponse;
+
+#endif
@@ -4,20 +4,14 @@
 #include <string.h>
 
 //CHAMP
-#define MAXLEN 1000 
-
 //typedef char t_field[1000]; moins efficace qu'avec un malloc 
 
 //BONUS 1 
-typedef char* t_field;  //Pointeur vers une chaîne dynamique
+typedef char* t_field;  //Pointeur vers une chaîne dynamique (longueur quelconque)
 
 //Initialiser un champ avec malloc
 t_field create_field(const char* valeur) {
     size_t len = strlen(valeur);
-    if (len > MAXLEN) {
-        fprintf(stderr, "Erreur : la taille du champ dépasse la limite de %d caractères.\n", MAXLEN);
-        return NULL;
-    }
     t_field field = (t_field)malloc((len + 1) * sizeof(char)); // Allocation dynamique, len+1 pour le caractère '\0'
     assert(field!=NULL); 
     strcpy(field, valeur); // Copier la chaîne dans le champ alloué
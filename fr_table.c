@@ -0,0 +1,365 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "fr_table.h"
+#include "fr_commun.h"
+
+// Structures
+// Entrée : une clé et ses définitions. Définition creuse : bitmap des champs
+// non vides (bit j : champ j+1, sur fieldWords(nbFields) mots) suivi des vues
+// des seuls champs non vides, dans l'ordre
+struct frEntry {
+    t_frView key;
+    uint64_t** definitions;
+    int nbDefinitions;
+    int capacity;          // Place allouée dans definitions (doublée quand elle est pleine)
+    struct frEntry* next;
+};
+
+// Agrandissement automatique : la table double quand nbKeys dépasse
+// MAX_LOAD_FACTOR * nbSlots, et les anciennes alvéoles sont migrées
+// REHASH_STEP par REHASH_STEP à chaque insertion
+#define MAX_LOAD_FACTOR 1.0
+#define REHASH_STEP 2
+#define ERROR_SIZE 256
+
+struct frTable {
+    t_frEntry** slots;
+    t_frEntry** oldSlots;  // Alvéoles en cours de migration (NULL sinon)
+    int oldNbSlots;
+    int rehashIndex;       // Prochaine ancienne alvéole à migrer
+    int nbSlots;
+    int nbKeys;
+    int hashFunction;
+    char sep;
+    int nbFields;
+    t_frView* fieldNames;
+    int skippedLines;      // Lignes de données sans clé, ignorées
+    int loaded;
+    t_arena* arena;        // Propriétaire des entrées, clés, définitions et noms
+    char error[ERROR_SIZE];
+};
+
+// Prototypes (fonctions internes)
+static t_frView allocateField(t_arena* arena, const char* source, size_t len);
+static int fieldWords(int nbFields);
+static uint64_t* packDefinition(t_arena* arena, char** fields, int nbFields);
+static unsigned int hashKey(const t_frTable* table, const char* key, size_t len, int nbSlots);
+static int setError(t_frTable* table, const char* format, ...);
+static void rehashStep(t_frTable* table, int nbBuckets);
+static t_frEntry* findEntry(const t_frTable* table, const char* key, size_t len, int* comparisons);
+static void insertEntry(t_frTable* table, t_frView key, uint64_t* definition);
+
+// Création d'une table vide de nbSlots alvéoles initiales (elle s'agrandit
+// seule) ; NULL si les paramètres sont invalides
+t_frTable* frOpen(int nbSlots, int hashFunction) {
+    if (nbSlots <= 0 || (hashFunction != FR_HASH_PRODUIT && hashFunction != FR_HASH_DJB2)) return NULL;
+    t_frTable* table = calloc(1, sizeof(t_frTable));
+    assert(table != NULL);
+    table->slots = calloc(nbSlots, sizeof(t_frEntry*));
+    assert(table->slots != NULL);
+    table->nbSlots = nbSlots;
+    table->hashFunction = hashFunction;
+    table->arena = createArena();
+    return table;
+}
+
+// Chargement d'un fichier .dat ; 0 en cas de succès, -1 sinon (voir frError)
+int frLoad(t_frTable* table, const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return setError(table, "Erreur d'ouverture de fichier %s : %s", filename, strerror(errno));
+    int status = frLoadStream(table, file);
+    fclose(file);
+    return status;
+}
+
+// Chargement depuis un flux déjà ouvert (séparateur, nombre de champs, noms
+// des champs, puis une ligne par définition ; lignes "#..." ignorées).
+// Une table ne se charge qu'une fois.
+int frLoadStream(t_frTable* table, FILE* file) {
+    if (table->loaded) return setError(table, "Erreur : table déjà chargée.");
+    table->loaded = 1;
+
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    int step = 0;
+    int status = 0;
+    while (status == 0 && (len = readLine(file, &line, &capacity)) >= 0) {
+
+        // Ignorer les commentaires
+        if (line[0] == '#' && len > 1) {
+            continue;
+        }
+
+        if (step == 0) {
+            // Séparateur
+            if (len != 1) {
+                status = setError(table, "Erreur : séparateur invalide (doit être un caractère unique).");
+                continue;
+            }
+            table->sep = line[0];
+        } else if (step == 1) {
+            // Nombre de champs
+            table->nbFields = atoi(line);
+            if (table->nbFields <= 0) {
+                status = setError(table, "Erreur : nombre de champs invalide : %s", line);
+                continue;
+            }
+        } else if (step == 2) {
+            // Noms des champs
+            char* names[table->nbFields];
+            splitFields(line, len, table->sep, names, table->nbFields);
+            table->fieldNames = arenaAlloc(table->arena, table->nbFields * sizeof(t_frView));
+            for (int i = 0; i < table->nbFields; i++) {
+                table->fieldNames[i] = allocateField(table->arena, names[i], strlen(names[i]));
+            }
+        } else {
+            // Données : la clé puis les champs non vides de la définition
+            char* fields[table->nbFields];
+            splitFields(line, len, table->sep, fields, table->nbFields);
+            if (fields[0][0] == '\0') {
+                table->skippedLines++;
+                continue;
+            }
+            t_frView key = allocateField(table->arena, fields[0], strlen(fields[0]));
+            insertEntry(table, key, packDefinition(table->arena, fields + 1, table->nbFields));
+        }
+        if (step < 3) step++;
+    }
+    free(line);
+
+    if (status == 0 && step < 3) status = setError(table, "Erreur : en-tête incomplet (séparateur, nombre et noms des champs).");
+
+    // Fin de la migration en cours : la table est stable pour les recherches
+    if (table->oldSlots) {
+        rehashStep(table, table->oldNbSlots - table->rehashIndex);
+    }
+    return status;
+}
+
+// Dernière erreur de chargement ("" s'il n'y en a pas eu)
+const char* frError(const t_frTable* table) {
+    return table->error;
+}
+
+// Libération de la table : entrées, clés et définitions partent avec l'arène
+void frClose(t_frTable* table) {
+    if (!table) return;
+    freeArena(table->arena);
+    free(table->oldSlots);
+    free(table->slots);
+    free(table);
+}
+
+char frSeparator(const t_frTable* table) {
+    return table->sep;
+}
+
+int frNbFields(const t_frTable* table) {
+    return table->nbFields;
+}
+
+// Nom du champ field (0 : la clé), vue vide hors limites
+t_frView frFieldName(const t_frTable* table, int field) {
+    t_frView empty = { "", 0 };
+    if (field < 0 || field >= table->nbFields || !table->fieldNames) return empty;
+    return table->fieldNames[field];
+}
+
+int frNbKeys(const t_frTable* table) {
+    return table->nbKeys;
+}
+
+int frNbSlots(const t_frTable* table) {
+    return table->nbSlots;
+}
+
+int frSkippedLines(const t_frTable* table) {
+    return table->skippedLines;
+}
+
+// Recherche d'une clé de len octets ; NULL si elle est absente.
+// comparisons (facultatif, NULL sinon) reçoit le nombre de clés comparées.
+const t_frEntry* frLookup(const t_frTable* table, const char* key, size_t len, int* comparisons) {
+    int count = 0;
+    const t_frEntry* entry = findEntry(table, key, len, &count);
+    if (comparisons) *comparisons = count;
+    return entry;
+}
+
+// Visite de toutes les entrées, dans l'ordre des alvéoles. Le parcours
+// s'arrête dès que visit renvoie une valeur non nulle, qui est renvoyée.
+int frIterate(const t_frTable* table, int (*visit)(const t_frEntry* entry, void* context), void* context) {
+    for (int i = 0; i < table->nbSlots; i++) {
+        for (const t_frEntry* entry = table->slots[i]; entry; entry = entry->next) {
+            int status = visit(entry, context);
+            if (status != 0) return status;
+        }
+    }
+    return 0;
+}
+
+t_frView frKey(const t_frEntry* entry) {
+    return entry->key;
+}
+
+int frNbDefinitions(const t_frEntry* entry) {
+    return entry->nbDefinitions;
+}
+
+// Champ field (1 à nbFields - 1, 0 : la clé) de la définition d'indice
+// definition ; vue vide si le champ est vide ou hors limites
+t_frView frField(const t_frTable* table, const t_frEntry* entry, int definition, int field) {
+    t_frView empty = { "", 0 };
+    if (field == 0) return entry->key;
+    if (definition < 0 || definition >= entry->nbDefinitions || field < 0 || field >= table->nbFields) return empty;
+    const uint64_t* bitmap = entry->definitions[definition];
+    int j = field - 1;
+    uint64_t bit = (uint64_t)1 << (j % 64);
+    const uint64_t* word = bitmap + j / 64;
+    if (!(*word & bit)) return empty;
+    int index = __builtin_popcountll(*word & (bit - 1));
+    for (const uint64_t* w = bitmap; w < word; w++) {
+        index += __builtin_popcountll(*w);
+    }
+    return ((const t_frView*)(bitmap + fieldWords(table->nbFields)))[index];
+}
+
+// Copie d'un champ dans l'arène (terminée par '\0', non comptée dans len)
+static t_frView allocateField(t_arena* arena, const char* source, size_t len) {
+    t_frView view = { arenaCopy(arena, source, len), len };
+    return view;
+}
+
+// Nombre de mots de 64 bits du bitmap d'une définition (nbFields - 1 champs)
+static int fieldWords(int nbFields) {
+    return (nbFields - 1 + 63) / 64;
+}
+
+// Copie des nbFields - 1 champs d'une définition dans l'arène : bitmap, puis
+// vues et chaînes des seuls champs non vides
+static uint64_t* packDefinition(t_arena* arena, char** fields, int nbFields) {
+    int words = fieldWords(nbFields);
+    int count = 0;
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j][0] != '\0') count++;
+    }
+    uint64_t* definition = arenaAlloc(arena, words * sizeof(uint64_t) + count * sizeof(t_frView));
+    memset(definition, 0, words * sizeof(uint64_t));
+    t_frView* values = (t_frView*)(definition + words);
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j][0] != '\0') {
+            definition[j / 64] |= (uint64_t)1 << (j % 64);
+            *values++ = allocateField(arena, fields[j], strlen(fields[j]));
+        }
+    }
+    return definition;
+}
+
+// Alvéole d'une clé parmi nbSlots (mêmes valeurs que les fonctions de programme2)
+static unsigned int hashKey(const t_frTable* table, const char* key, size_t len, int nbSlots) {
+    unsigned int hash;
+    if (table->hashFunction == FR_HASH_PRODUIT) {
+        hash = 0;
+        for (size_t i = 0; i < len; i++) hash = (hash * 31) + key[i];
+    } else {
+        hash = 5381;
+        for (size_t i = 0; i < len; i++) hash = ((hash << 5) + hash) + key[i];
+    }
+    return hash % nbSlots;
+}
+
+// Message de la dernière erreur ; renvoie toujours -1
+static int setError(t_frTable* table, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(table->error, ERROR_SIZE, format, args);
+    va_end(args);
+    return -1;
+}
+
+// Migration des nbBuckets anciennes alvéoles suivantes vers les nouvelles
+static void rehashStep(t_frTable* table, int nbBuckets) {
+    while (table->oldSlots && nbBuckets-- > 0) {
+        t_frEntry* current = table->oldSlots[table->rehashIndex];
+        while (current) {
+            t_frEntry* next = current->next;
+            unsigned int index = hashKey(table, current->key.data, current->key.len, table->nbSlots);
+            current->next = table->slots[index];
+            table->slots[index] = current;
+            current = next;
+        }
+        table->oldSlots[table->rehashIndex] = NULL;
+        table->rehashIndex++;
+        if (table->rehashIndex == table->oldNbSlots) {
+            free(table->oldSlots);
+            table->oldSlots = NULL;
+            table->oldNbSlots = 0;
+        }
+    }
+}
+
+// Recherche de l'entrée d'une clé, dans l'ancienne alvéole aussi pendant une migration
+static t_frEntry* findEntry(const t_frTable* table, const char* key, size_t len, int* comparisons) {
+    for (t_frEntry* current = table->slots[hashKey(table, key, len, table->nbSlots)]; current; current = current->next) {
+        (*comparisons)++;
+        if (current->key.len == len && memcmp(current->key.data, key, len) == 0) return current;
+    }
+    if (table->oldSlots) {
+        unsigned int oldIndex = hashKey(table, key, len, table->oldNbSlots);
+        if (oldIndex >= (unsigned int)table->rehashIndex) {
+            for (t_frEntry* current = table->oldSlots[oldIndex]; current; current = current->next) {
+                (*comparisons)++;
+                if (current->key.len == len && memcmp(current->key.data, key, len) == 0) return current;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Insertion d'une définition : nouvelle entrée, ou occurrence de plus pour une
+// clé déjà présente. La clé et la définition sont allouées dans l'arène de la table.
+static void insertEntry(t_frTable* table, t_frView key, uint64_t* definition) {
+    int comparisons = 0;
+    t_frEntry* current = findEntry(table, key.data, key.len, &comparisons);
+    if (current) {
+        // Tableau doublé quand il est plein : ajouts en temps amorti constant
+        if (current->nbDefinitions == current->capacity) {
+            current->capacity *= 2;
+            uint64_t** definitions = arenaAlloc(table->arena, current->capacity * sizeof(uint64_t*));
+            memcpy(definitions, current->definitions, current->nbDefinitions * sizeof(uint64_t*));
+            current->definitions = definitions;
+        }
+        current->definitions[current->nbDefinitions++] = definition;
+        return;
+    }
+
+    // Agrandissement : migration progressive, ou doublement si la table est trop pleine
+    if (table->oldSlots) {
+        rehashStep(table, REHASH_STEP);
+    } else if (table->nbKeys + 1 > MAX_LOAD_FACTOR * table->nbSlots) {
+        table->oldSlots = table->slots;
+        table->oldNbSlots = table->nbSlots;
+        table->rehashIndex = 0;
+        table->nbSlots *= 2;
+        table->slots = calloc(table->nbSlots, sizeof(t_frEntry*));
+        assert(table->slots != NULL);
+    }
+
+    unsigned int index = hashKey(table, key.data, key.len, table->nbSlots);
+    t_frEntry* entry = arenaAlloc(table->arena, sizeof(t_frEntry));
+    entry->key = key;
+    entry->definitions = arenaAlloc(table->arena, sizeof(uint64_t*));
+    entry->definitions[0] = definition;
+    entry->nbDefinitions = 1;
+    entry->capacity = 1;
+    entry->next = table->slots[index];
+    table->slots[index] = entry;
+    table->nbKeys++;
+}
@@ -0,0 +1,60 @@
+#ifndef FR_TABLE_H
+#define FR_TABLE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Bibliothèque de tables de dictionnaire (fichiers .dat de Tables/) : une
+// table de hachage à chaînage, agrandie progressivement au chargement, derrière
+// un descripteur opaque. Les recherches ne renvoient pas de texte affiché mais
+// des vues sur les champs, valables jusqu'à frClose.
+//
+// Utilisation :
+//     t_frTable* table = frOpen(1024, FR_HASH_DJB2);
+//     if (frLoad(table, "Tables/verbes.dat") < 0) fprintf(stderr, "%s\n", frError(table));
+//     const t_frEntry* entry = frLookup(table, "aborder", 7, NULL);
+//     t_frView definition = frField(table, entry, 0, 1);
+//     frClose(table);
+//
+// Aucune fonction ne termine le programme : les erreurs de chargement sont
+// signalées par la valeur de retour et décrites par frError. Une fois la table
+// chargée, frLookup, frIterate et les accesseurs ne la modifient pas et
+// peuvent être appelés par plusieurs threads en même temps.
+
+// Fonctions de hachage (celles de programme2)
+#define FR_HASH_PRODUIT 1   // hash * 31 + octet
+#define FR_HASH_DJB2    2   // hash * 33 + octet, départ 5381
+
+typedef struct frTable t_frTable;
+typedef struct frEntry t_frEntry;
+
+// Vue sur un texte de la table (pas forcément terminé par '\0' pour
+// l'appelant : toujours utiliser len)
+typedef struct {
+    const char* data;
+    size_t len;
+} t_frView;
+
+// Cycle de vie
+t_frTable* frOpen(int nbSlots, int hashFunction);
+int frLoad(t_frTable* table, const char* filename);
+int frLoadStream(t_frTable* table, FILE* file);
+const char* frError(const t_frTable* table);
+void frClose(t_frTable* table);
+
+// Description de la table chargée
+char frSeparator(const t_frTable* table);
+int frNbFields(const t_frTable* table);
+t_frView frFieldName(const t_frTable* table, int field);
+int frNbKeys(const t_frTable* table);
+int frNbSlots(const t_frTable* table);
+int frSkippedLines(const t_frTable* table);
+
+// Recherche et parcours
+const t_frEntry* frLookup(const t_frTable* table, const char* key, size_t len, int* comparisons);
+int frIterate(const t_frTable* table, int (*visit)(const t_frEntry* entry, void* context), void* context);
+t_frView frKey(const t_frEntry* entry);
+int frNbDefinitions(const t_frEntry* entry);
+t_frView frField(const t_frTable* table, const t_frEntry* entry, int definition, int field);
+
+#endif
@@ -2,17 +2,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "fr_commun.h"
 
 // Définition des structures
+// Définition creuse : bitmap des champs non vides (bit j : champ j+1, sur
+// fieldWords(nbFields) mots), suivi des seules chaînes non vides, dans l'ordre.
+// Un champ vide ne coûte qu'un bit ; definitionField retrouve un champ.
 typedef struct {
-    char* key;       // Clé dynamique
-    char** value;    // Tableau dynamique de champs
+    char* key;            // Clé dynamique
+    uint64_t* definition; // Champs de la définition, sous forme creuse
 } t_tuple;
 
 typedef struct {
     t_tuple* tuples; // Tableau dynamique de tuples
     int sizeTab;     // Taille allouée
     int nbTuples;    // Nombre de tuples enregistrés
+    t_arena* arena;  // Propriétaire des clés et des champs
 } t_tupletable;
 
 typedef struct {
@@ -22,42 +30,108 @@ typedef struct {
 } t_metadata;
 
 // Prototypes
-char* readLine(FILE* file);
-char* allocateField(const char* source);
+char* allocateField(t_arena* arena, const char* source);
+int fieldWords(int nbFields);
+uint64_t* packDefinition(t_arena* arena, char** fields, int nbFields);
+const char* definitionField(const uint64_t* definition, int nbFields, int field);
 int compareTuples(const void* a, const void* b);
 t_tupletable* parseFile(const char* filename, t_metadata* metadata);
+void printTuple(const t_tuple* tuple, t_metadata* metadata);
+void printSearch(t_tupletable* table, t_metadata* metadata, const char* key, int first, int last, int comparisons);
+int findKey(t_tupletable* table, const char* key, int* comparisons);
 void searchKey(t_tupletable* table, t_metadata* metadata, const char* key);
+int lowerBound(t_tupletable* table, const char* key, int* comparisons);
+int findKeyBinary(t_tupletable* table, const char* key, int* comparisons, int* last);
+void searchKeyBinary(t_tupletable* table, t_metadata* metadata, const char* key);
+void searchPrefix(t_tupletable* table, const char* prefix);
+double now(void);
+char** readQueries(const char* filename, t_arena* arena, int* nbQueries);
+void runBatch(t_tupletable* table, t_metadata* metadata, char** queries, int nbQueries, char mode, int quiet);
+int compareDoubles(const void* a, const void* b);
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies);
+void csvReport(t_tupletable* table, const char* tableFile, const char* queryFile, char** queries, int nbQueries, char mode, double buildTime);
 
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <filename>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <filename> [-l|-b|-c] [-q<fichier requêtes> [-muet|-csv]]\n", argv[0]);
+        fprintf(stderr, "  -l recherche linéaire, -b recherche dichotomique (défaut), -c les deux\n");
+        fprintf(stderr, "  une clé terminée par '*' liste tous les mots commençant par ce préfixe\n");
+        fprintf(stderr, "  -q recherche tous les mots du fichier (un par ligne) et mesure le débit\n");
+        fprintf(stderr, "  -muet n'affiche pas le résultat de chaque recherche\n");
+        fprintf(stderr, "  -csv affiche une ligne CSV par mode (construction, mémoire, centiles de latence)\n");
         exit(EXIT_FAILURE);
     }
 
     const char* filename = argv[1];
+    const char* queryFile = NULL;
+    int quiet = 0;
+    int csvMode = 0;
+    char mode = 'b';
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "-c") == 0) {
+            mode = argv[i][1];
+        } else if (strncmp(argv[i], "-q", 2) == 0) {
+            queryFile = argv[i] + 2;
+        } else if (strcmp(argv[i], "-muet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "-csv") == 0) {
+            csvMode = 1;
+        } else {
+            fprintf(stderr, "Erreur : mode de recherche inconnu %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (csvMode && !queryFile) {
+        fprintf(stderr, "Erreur : -csv s'utilise avec -q<fichier requêtes>.\n");
+        exit(EXIT_FAILURE);
+    }
     t_metadata metadata;
+    double buildStart = now();
     t_tupletable* table = parseFile(filename, &metadata);
+    double buildTime = now() - buildStart;
+
+    // Mode par lot : toutes les requêtes du fichier, puis le bilan
+    if (queryFile) {
+        t_arena* queryArena = createArena();
+        int nbQueries;
+        char** queries = readQueries(queryFile, queryArena, &nbQueries);
+        if (csvMode) {
+            if (mode == 'l' || mode == 'c') csvReport(table, filename, queryFile, queries, nbQueries, 'l', buildTime);
+            if (mode == 'b' || mode == 'c') csvReport(table, filename, queryFile, queries, nbQueries, 'b', buildTime);
+        } else {
+            printf("%d mots indexés, %d requêtes\n", table->nbTuples, nbQueries);
+            if (mode == 'l' || mode == 'c') runBatch(table, &metadata, queries, nbQueries, 'l', quiet);
+            if (mode == 'b' || mode == 'c') runBatch(table, &metadata, queries, nbQueries, 'b', quiet);
+        }
+        free(queries);
+        freeArena(queryArena);
+    }
 
-    printf("%d mots indexés\n", table->nbTuples);
-    printf("Saisir les mots recherchés :\n");
+    if (!queryFile) {
+        printf("%d mots indexés\n", table->nbTuples);
+        printf("Saisir les mots recherchés :\n");
+    }
 
     char key[1000];
-    while (fgets(key, sizeof(key), stdin)) {
+    while (!queryFile && fgets(key, sizeof(key), stdin)) {
         size_t len = strlen(key);
         if (key[len - 1] == '\n') key[len - 1] = '\0';
         if (strlen(key) == 0) break;
-        searchKey(table, &metadata, key);
-    }
 
-    // Libération de la mémoire
-    for (int i = 0; i < table->nbTuples; i++) {
-        free(table->tuples[i].key);
-        for (int j = 0; j < metadata.nbFields - 1; j++) {
-            free(table->tuples[i].value[j]);
+        // Recherche par préfixe
+        if (key[strlen(key) - 1] == '*') {
+            key[strlen(key) - 1] = '\0';
+            searchPrefix(table, key);
+            continue;
         }
-        free(table->tuples[i].value);
+
+        if (mode == 'l' || mode == 'c') searchKey(table, &metadata, key);
+        if (mode == 'b' || mode == 'c') searchKeyBinary(table, &metadata, key);
     }
+
+    // Libération de la mémoire : clés et champs partent avec l'arène
+    freeArena(table->arena);
     free(table->tuples);
     for (int i = 0; i < metadata.nbFields; i++) {
         free(metadata.fieldNames[i]);
@@ -69,31 +143,57 @@ int main(int argc, char* argv[]) {
 }
 
 
-// Lecture d'une ligne
-char* readLine(FILE* file) {
-    char buffer[1000];
-    if (fgets(buffer, sizeof(buffer), file) == NULL) {
-        return NULL;
-    }
-    size_t len = strlen(buffer);
-    if (buffer[len - 1] == '\n') buffer[len - 1] = '\0';
-    char* line = malloc(len + 1);
-    assert(line!=NULL); 
-    strcpy(line, buffer);
-    return line;
-}
-
-// Allocation dynamique d'un champ
-char* allocateField(const char* source) {
-    char* field = malloc(strlen(source) + 1);
+// Allocation d'un champ dans l'arène (ou par malloc si arena vaut NULL)
+char* allocateField(t_arena* arena, const char* source) {
+    size_t len = strlen(source);
+    if (arena) return arenaCopy(arena, source, len);
+    char* field = malloc(len + 1);
     if (!field) {
         perror("Erreur d'allocation mémoire pour un champ");
         exit(EXIT_FAILURE);
     }
-    strcpy(field, source);
+    memcpy(field, source, len + 1);
     return field;
 }
 
+// Nombre de mots de 64 bits du bitmap d'une définition (nbFields - 1 champs)
+int fieldWords(int nbFields) {
+    return (nbFields - 1 + 63) / 64;
+}
+
+// Copie des nbFields - 1 champs d'une définition dans l'arène : bitmap, puis
+// pointeurs et chaînes des seuls champs non vides
+uint64_t* packDefinition(t_arena* arena, char** fields, int nbFields) {
+    int words = fieldWords(nbFields);
+    int count = 0;
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j][0] != '\0') count++;
+    }
+    uint64_t* definition = arenaAlloc(arena, words * sizeof(uint64_t) + count * sizeof(char*));
+    memset(definition, 0, words * sizeof(uint64_t));
+    char** values = (char**)(definition + words);
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j][0] != '\0') {
+            definition[j / 64] |= (uint64_t)1 << (j % 64);
+            *values++ = allocateField(arena, fields[j]);
+        }
+    }
+    return definition;
+}
+
+// Champ field (0 à nbFields - 2) d'une définition, chaîne vide s'il est vide :
+// son rang parmi les champs non vides est le nombre de bits à 1 qui le précèdent
+const char* definitionField(const uint64_t* definition, int nbFields, int field) {
+    uint64_t bit = (uint64_t)1 << (field % 64);
+    const uint64_t* word = definition + field / 64;
+    if (!(*word & bit)) return "";
+    int index = __builtin_popcountll(*word & (bit - 1));
+    for (const uint64_t* w = definition; w < word; w++) {
+        index += __builtin_popcountll(*w);
+    }
+    return ((char* const*)(definition + fieldWords(nbFields)))[index];
+}
+
 // Comparer tuples par clé
 int compareTuples(const void* a, const void* b) {
     const t_tuple* t1 = (const t_tuple*)a;
@@ -115,44 +215,53 @@ t_tupletable* parseFile(const char* filename, t_metadata* metadata) {
     assert(table->tuples!=NULL); 
     table->sizeTab = 10;
     table->nbTuples = 0;
+    table->arena = createArena();
 
     metadata->sep = '\0';
     metadata->nbFields = 0;
     metadata->fieldNames = NULL;
 
-    char* line;
-    while ((line = readLine(file)) != NULL) {
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = readLine(file, &line, &capacity)) >= 0) {
         
         // Ignore les commentaires
-        if (line[0] == '#' && strlen(line) > 1) {
-            free(line);
+        if (line[0] == '#' && len > 1) {
             continue;
         }
 
         // Séparateur
-        if (strlen(line) == 1 && metadata->sep == '\0') {
+        if (len == 1 && metadata->sep == '\0') {
             metadata->sep = line[0];
-            free(line);
             continue;
         }
 
         // Nombre de champs
         if (metadata->nbFields == 0) {
             metadata->nbFields = atoi(line);
-            metadata->fieldNames = malloc(metadata->nbFields * sizeof(char*));
+            if (metadata->nbFields <= 0) {
+                fprintf(stderr, "Erreur : nombre de champs invalide : %s\n", line);
+                exit(EXIT_FAILURE);
+            }
+            metadata->fieldNames = calloc(metadata->nbFields, sizeof(char*));
             assert(metadata->fieldNames !=NULL); 
-            free(line);
             continue;
         }
 
+        char* fields[metadata->nbFields];
+        splitFields(line, len, metadata->sep, fields, metadata->nbFields);
+
         // Noms des champs
         if (metadata->fieldNames[0] == NULL) {
-            char* token = strtok(line, &metadata->sep);
             for (int i = 0; i < metadata->nbFields; i++) {
-                metadata->fieldNames[i] = allocateField(token ? token : "");
-                token = strtok(NULL, &metadata->sep);
+                metadata->fieldNames[i] = allocateField(NULL, fields[i]);
             }
-            free(line);
+            continue;
+        }
+
+        // Ligne sans clé (ligne vide ou commençant par le séparateur)
+        if (fields[0][0] == '\0') {
             continue;
         }
 
@@ -163,22 +272,16 @@ t_tupletable* parseFile(const char* filename, t_metadata* metadata) {
         }
 
         t_tuple* tuple = &table->tuples[table->nbTuples];
-        char* token = strtok(line, &metadata->sep);
 
         // Lecture de la clé
-        tuple->key = allocateField(token);
+        tuple->key = allocateField(table->arena, fields[0]);
 
-        // Lecture des valeurs
-        tuple->value = malloc((metadata->nbFields - 1) * sizeof(char*));
-        assert(tuple->value !=NULL); 
-        for (int i = 0; i < metadata->nbFields - 1; i++) {
-            token = strtok(NULL, &metadata->sep);
-            tuple->value[i] = allocateField(token ? token : "");
-        }
+        // Lecture des valeurs (seuls les champs non vides sont copiés)
+        tuple->definition = packDefinition(table->arena, fields + 1, metadata->nbFields);
 
         table->nbTuples++;
-        free(line);
     }
+    free(line);
 
     fclose(file);
 
@@ -188,20 +291,225 @@ t_tupletable* parseFile(const char* filename, t_metadata* metadata) {
     return table;
 }
 
-// Rechercher une clé
+// Affichage d'un tuple
+void printTuple(const t_tuple* tuple, t_metadata* metadata) {
+    printf("mot : %s\n", tuple->key);
+    for (int j = 0; j < metadata->nbFields - 1; j++) {
+        const char* field = definitionField(tuple->definition, metadata->nbFields, j);
+        printf("%s : %s\n", metadata->fieldNames[j + 1], field[0] != '\0' ? field : "X");
+    }
+}
+
+// Affichage du résultat d'une recherche : tuples d'indices [first, last[
+void printSearch(t_tupletable* table, t_metadata* metadata, const char* key, int first, int last, int comparisons) {
+    if (first >= last) {
+        printf("Recherche de %s : échec ! nb comparaisons : %d\n", key, comparisons);
+        return;
+    }
+    printf("Recherche de %s : trouvé ! nb comparaisons : %d\n", key, comparisons);
+    for (int i = first; i < last; i++) {
+        printTuple(&table->tuples[i], metadata);
+    }
+}
+
+// Parcours linéaire : indice du premier tuple de clé key, -1 si absente
+int findKey(t_tupletable* table, const char* key, int* comparisons) {
+    for (int i = 0; i < table->nbTuples; i++) {
+        (*comparisons)++;
+        if (strcmp(table->tuples[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Rechercher une clé (parcours linéaire)
 void searchKey(t_tupletable* table, t_metadata* metadata, const char* key) {
     int comparisons = 0;
-    for (int i = 0; i < table->nbTuples; i++) {
+    int i = findKey(table, key, &comparisons);
+    printSearch(table, metadata, key, i, i < 0 ? i : i + 1, comparisons);
+}
+
+// Recherche dichotomique : indice du premier tuple dont la clé est >= key
+// (nbTuples si toutes les clés sont plus petites)
+int lowerBound(t_tupletable* table, const char* key, int* comparisons) {
+    int low = 0;
+    int high = table->nbTuples;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        (*comparisons)++;
+        if (strcmp(table->tuples[middle].key, key) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Dichotomie sur la table triée : les doublons éventuels sont contigus après
+// le tri et forment l'intervalle [indice renvoyé, *last[ (vide si absente)
+int findKeyBinary(t_tupletable* table, const char* key, int* comparisons, int* last) {
+    int first = lowerBound(table, key, comparisons);
+    *last = first;
+    while (*last < table->nbTuples) {
+        (*comparisons)++;
+        if (strcmp(table->tuples[*last].key, key) != 0) break;
+        (*last)++;
+    }
+    return first;
+}
+
+// Rechercher une clé (dichotomie) et afficher toutes ses occurrences
+void searchKeyBinary(t_tupletable* table, t_metadata* metadata, const char* key) {
+    int comparisons = 0;
+    int last;
+    int first = findKeyBinary(table, key, &comparisons, &last);
+    printSearch(table, metadata, key, first, last, comparisons);
+}
+
+// Rechercher toutes les clés commençant par prefix
+// Les clés concernées forment un intervalle [first, last[ de la table triée.
+void searchPrefix(t_tupletable* table, const char* prefix) {
+    int comparisons = 0;
+    size_t len = strlen(prefix);
+    int first = lowerBound(table, prefix, &comparisons);
+
+    // Borne supérieure : premier tuple après first qui ne commence plus par prefix
+    int low = first;
+    int high = table->nbTuples;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
         comparisons++;
-        if (strcmp(table->tuples[i].key, key) == 0) {
-            printf("Recherche de %s : trouvé ! nb comparaisons : %d\n", key, comparisons);
-            printf("mot : %s\n", table->tuples[i].key);
-            for (int j = 0; j < metadata->nbFields - 1; j++) {
-                printf("%s : %s\n", metadata->fieldNames[j + 1],
-                    strlen(table->tuples[i].value[j]) > 0 ? table->tuples[i].value[j] : "X");
+        if (strncmp(table->tuples[middle].key, prefix, len) == 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    int last = low;
+
+    printf("Recherche du préfixe %s : %d mots trouvés ! nb comparaisons : %d\n", prefix, last - first, comparisons);
+    for (int i = first; i < last; i++) {
+        printf("mot : %s\n", table->tuples[i].key);
+    }
+}
+
+// Horloge monotone en secondes
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Lecture d'un fichier de requêtes (un mot par ligne, lignes vides ignorées)
+char** readQueries(const char* filename, t_arena* arena, int* nbQueries) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Erreur d'ouverture du fichier de requêtes");
+        exit(EXIT_FAILURE);
+    }
+    int size = 1024;
+    char** queries = malloc(size * sizeof(char*));
+    assert(queries != NULL);
+    *nbQueries = 0;
+
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = readLine(file, &line, &capacity)) >= 0) {
+        if (len > 0) {
+            if (*nbQueries >= size) {
+                size *= 2;
+                queries = realloc(queries, size * sizeof(char*));
+                assert(queries != NULL);
             }
-            return;
+            queries[(*nbQueries)++] = allocateField(arena, line);
+        }
+    }
+    free(line);
+    fclose(file);
+    return queries;
+}
+
+// Recherche de toutes les requêtes ('l' : linéaire, 'b' : dichotomique) et bilan :
+// temps total, débit, trouvés/absents, comparaisons moyenne et maximale.
+// En mode muet, seul le bilan est affiché (les entrées-sorties ne faussent pas la mesure).
+void runBatch(t_tupletable* table, t_metadata* metadata, char** queries, int nbQueries, char mode, int quiet) {
+    int found = 0;
+    int maxComparisons = 0;
+    long totalComparisons = 0;
+
+    double start = now();
+    for (int q = 0; q < nbQueries; q++) {
+        int comparisons = 0;
+        int first, last;
+        if (mode == 'l') {
+            first = findKey(table, queries[q], &comparisons);
+            last = first < 0 ? first : first + 1;
+        } else {
+            first = findKeyBinary(table, queries[q], &comparisons, &last);
         }
+        if (!quiet) printSearch(table, metadata, queries[q], first, last, comparisons);
+        if (first < last) found++;
+        totalComparisons += comparisons;
+        if (comparisons > maxComparisons) maxComparisons = comparisons;
     }
-    printf("Recherche de %s : échec ! nb comparaisons : %d\n", key, comparisons);
-}
\ No newline at end of file
+    double elapsed = now() - start;
+
+    printf("Recherche %s : %d requêtes en %.3f ms (%.0f recherches/s)\n", mode == 'l' ? "linéaire" : "dichotomique",
+        nbQueries, elapsed * 1000, elapsed > 0 ? nbQueries / elapsed : 0);
+    printf("  trouvés : %d, absents : %d\n", found, nbQueries - found);
+    printf("  comparaisons : moyenne %.2f, max %d\n", nbQueries > 0 ? (double)totalComparisons / nbQueries : 0, maxComparisons);
+}
+
+// Ordre croissant de deux durées (tri des latences)
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Ligne CSV d'un banc d'essai (colonnes dans l'ordre de l'en-tête de make bench) :
+// programme, moteur, table, requetes, nb_cles, nb_requetes, trouves,
+// construction_ms, rss_max_ko, moyenne_ns, p50_ns, p90_ns, p99_ns, max_ns.
+// La mémoire est le pic du processus (getrusage) ; latencies est trié sur place.
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double total = 0;
+    for (int q = 0; q < nbQueries; q++) total += latencies[q];
+    qsort(latencies, nbQueries, sizeof(double), compareDoubles);
+    printf("prog1,%s,%s,%s,%d,%d,%d,%.3f,%ld", engine, tableFile, queryFile, nbKeys, nbQueries, found, buildTime * 1000, usage.ru_maxrss);
+    if (nbQueries > 0) {
+        printf(",%.0f,%.0f,%.0f,%.0f,%.0f\n", total * 1e9 / nbQueries, latencies[nbQueries / 2] * 1e9,
+            latencies[(int)(nbQueries * 0.9)] * 1e9, latencies[(int)(nbQueries * 0.99)] * 1e9, latencies[nbQueries - 1] * 1e9);
+    } else {
+        printf(",0,0,0,0,0\n");
+    }
+}
+
+// Latence de chaque recherche ('l' : linéaire, 'b' : dichotomique), sans
+// affichage, puis la ligne CSV du mode. Une seule lecture d'horloge par
+// requête : la fin d'une recherche est le début de la suivante.
+void csvReport(t_tupletable* table, const char* tableFile, const char* queryFile, char** queries, int nbQueries, char mode, double buildTime) {
+    double* latencies = malloc((nbQueries + 1) * sizeof(double));
+    assert(latencies != NULL);
+    int found = 0;
+    double previous = now();
+    for (int q = 0; q < nbQueries; q++) {
+        int comparisons = 0;
+        int first, last;
+        if (mode == 'l') {
+            first = findKey(table, queries[q], &comparisons);
+            last = first < 0 ? first : first + 1;
+        } else {
+            first = findKeyBinary(table, queries[q], &comparisons, &last);
+        }
+        double current = now();
+        latencies[q] = current - previous;
+        previous = current;
+        if (first < last) found++;
+    }
+    printCsvRow(mode == 'l' ? "lineaire" : "dichotomique", tableFile, queryFile, table->nbTuples, nbQueries, found, buildTime, latencies);
+    free(latencies);
+}
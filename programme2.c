@@ -2,45 +2,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "fr_table.h"
 
-// Structures
-typedef struct {
-    char* key;
-    char*** definitions;
-    int nbDefinitions;
-} t_tuple;
-
-typedef struct node {
-    t_tuple data;
-    struct node* next;
-} t_node;
-
-typedef struct {
-    char sep;
-    int nbFields;
-    char** fieldNames;
-} t_metadata;
-
-typedef struct {
-    t_node** slots;
-    int nbSlots;
-    int nbTuples;
-} t_hashtable;
+// Interface en ligne de commande de la bibliothèque fr_table : chargement
+// d'un fichier .dat, puis recherche des mots saisis ou d'un fichier de requêtes
 
 // Prototypes
-char* readLine(FILE* file);
-char* allocateField(const char* source);
-t_hashtable* parseFileHash(const char* filename, t_metadata* metadata, int nbSlots, unsigned int (*hashFunc)(const char*, int));
-void insertTupleHash(t_hashtable* table, const t_tuple* tuple, int nbSlots, t_metadata* metadata, unsigned int (*hashFunc)(const char*, int));
-void searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int nbSlots, unsigned int (*hashFunc)(const char*, int));
-unsigned int hashFunction(const char* key, int nbSlots);
-unsigned int hashFunction1(const char* key, int nbSlots);
-unsigned int hashFunction2(const char* key, int nbSlots);
-void freeHashTable(t_hashtable* table, t_metadata* metadata);
+void printSearchHash(const t_frTable* table, const char* key, const t_frEntry* entry, int comparisons);
+void searchKeyHash(const t_frTable* table, const char* key);
+double now(void);
+char** readQueries(const char* filename, char** text, int* nbQueries);
+void runBatch(const t_frTable* table, char** queries, int nbQueries, int quiet);
+int compareDoubles(const void* a, const void* b);
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies);
+void csvReport(const t_frTable* table, const char* tableFile, const char* queryFile, char** queries, int nbQueries, double buildTime);
 
 int main(int argc, char* argv[]) {
     if (argc < 4) {
-        fprintf(stderr, "Usage: %s <filename> <nbSlots> <hashFunctionChoice>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <filename> <nbSlots> <hashFunctionChoice> [-q<fichier requêtes> [-muet|-csv]]\n", argv[0]);
+        fprintf(stderr, "  nbSlots est le nombre initial d'alvéoles : la table s'agrandit seule\n");
+        fprintf(stderr, "  -q recherche tous les mots du fichier (un par ligne) et mesure le débit\n");
+        fprintf(stderr, "  -muet n'affiche pas le résultat de chaque recherche\n");
+        fprintf(stderr, "  -csv affiche une ligne CSV (construction, mémoire, centiles de latence)\n");
         exit(EXIT_FAILURE);
     }
 
@@ -51,21 +36,70 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "Erreur : nbSlots doit être supérieur à 0.\n");
         exit(EXIT_FAILURE);
     }
-
-    unsigned int (*hashFunc)(const char*, int) = NULL;
-    if (hashFunctionChoice == 1) {
-        hashFunc = hashFunction1;
-    } else if (hashFunctionChoice == 2) {
-        hashFunc = hashFunction2;
-    } else {
+    if (hashFunctionChoice != FR_HASH_PRODUIT && hashFunctionChoice != FR_HASH_DJB2) {
         fprintf(stderr, "Erreur : choix de fonction de hachage invalide (1 ou 2).\n");
         exit(EXIT_FAILURE);
     }
 
-    t_metadata metadata;
-    t_hashtable* table = parseFileHash(filename, &metadata, nbSlots, hashFunc);
+    const char* queryFile = NULL;
+    int quiet = 0;
+    int csvMode = 0;
+    for (int i = 4; i < argc; i++) {
+        if (strncmp(argv[i], "-q", 2) == 0) {
+            queryFile = argv[i] + 2;
+        } else if (strcmp(argv[i], "-muet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "-csv") == 0) {
+            csvMode = 1;
+        } else {
+            fprintf(stderr, "Erreur : option inconnue %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (csvMode && !queryFile) {
+        fprintf(stderr, "Erreur : -csv s'utilise avec -q<fichier requêtes>.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t_frTable* table = frOpen(nbSlots, hashFunctionChoice);
+    double buildStart = now();
+    if (frLoad(table, filename) < 0) {
+        fprintf(stderr, "%s\n", frError(table));
+        frClose(table);
+        exit(EXIT_FAILURE);
+    }
+    double buildTime = now() - buildStart;
+    if (frSkippedLines(table) > 0) {
+        fprintf(stderr, "Erreur : %d lignes mal formatées, clé manquante.\n", frSkippedLines(table));
+    }
+
+    if (!csvMode) {
+        printf("Séparateur détecté : '%c'\n", frSeparator(table));
+        printf("%d champs détectés.\n", frNbFields(table));
+        printf("Noms des champs : ");
+        for (int i = 0; i < frNbFields(table); i++) {
+            t_frView name = frFieldName(table, i);
+            printf("%.*s%s", (int)name.len, name.data, (i == frNbFields(table) - 1) ? "\n" : ", ");
+        }
+        printf("%d mots indexés dans %d alvéoles\n", frNbKeys(table), frNbSlots(table));
+    }
+
+    // Mode par lot : toutes les requêtes du fichier, puis le bilan
+    if (queryFile) {
+        char* text;
+        int nbQueries;
+        char** queries = readQueries(queryFile, &text, &nbQueries);
+        if (csvMode) {
+            csvReport(table, filename, queryFile, queries, nbQueries, buildTime);
+        } else {
+            runBatch(table, queries, nbQueries, quiet);
+        }
+        free(queries);
+        free(text);
+        frClose(table);
+        return 0;
+    }
 
-    printf("%d mots indexés dans %d alvéoles\n", table->nbTuples, nbSlots);
     printf("Saisir les mots recherchés :\n\n");
 
     char key[1000];
@@ -73,264 +107,153 @@ int main(int argc, char* argv[]) {
         size_t len = strlen(key);
         if (key[len - 1] == '\n') key[len - 1] = '\0';
         if (strlen(key) == 0) break;
-        searchKeyHash(table, &metadata, key, nbSlots, hashFunc);
+        searchKeyHash(table, key);
     }
 
-    freeHashTable(table, &metadata);
+    frClose(table);
     return 0;
 }
 
-// Lecture d'une ligne
-char* readLine(FILE* file) {
-    char buffer[1000];
-    if (fgets(buffer, sizeof(buffer), file) == NULL) {
-        return NULL;
+// Affichage du résultat d'une recherche (entry vaut NULL en cas d'échec)
+void printSearchHash(const t_frTable* table, const char* key, const t_frEntry* entry, int comparisons) {
+    if (entry) {
+        t_frView word = frKey(entry);
+        printf("Recherche de %s : trouvé ! nb comparaisons : %d\n", key, comparisons);
+        printf("mot : %.*s\n", (int)word.len, word.data);
+        for (int d = 0; d < frNbDefinitions(entry); d++) {
+            printf("Définition %d :\n", d + 1);
+            for (int j = 1; j < frNbFields(table); j++) {
+                t_frView name = frFieldName(table, j);
+                t_frView field = frField(table, entry, d, j);
+                printf("  %.*s : %.*s\n", (int)name.len, name.data, field.len > 0 ? (int)field.len : 1, field.len > 0 ? field.data : "X");
+            }
+            printf("\n");
+        }
+    } else {
+        printf("Recherche de %s : échec ! nb comparaisons : %d\n", key, comparisons);
     }
-    size_t len = strlen(buffer);
-    if (buffer[len - 1] == '\n') buffer[len - 1] = '\0';
-    char* line = malloc(len + 1);
-    assert(line != NULL); 
-    strcpy(line, buffer);
-    return line;
 }
 
-// Allocation dynamique d'un champ
-char* allocateField(const char* source) {
-    char* field = malloc(strlen(source) + 1);
-    assert(field != NULL); 
-    strcpy(field, source);
-    return field;
+// Rechercher une clé et afficher ses définitions
+void searchKeyHash(const t_frTable* table, const char* key) {
+    int comparisons;
+    const t_frEntry* entry = frLookup(table, key, strlen(key), &comparisons);
+    printSearchHash(table, key, entry, comparisons);
 }
 
-// Fonction de hachage 1
-unsigned int hashFunction1(const char* key, int nbSlots) {
-    unsigned int hash = 0;
-    while (*key) {
-        hash = (hash * 31) + *key++;
-    }
-    return hash % nbSlots;
-}
-
-// Fonction de hachage 2
-unsigned int hashFunction2(const char* key, int nbSlots) {
-    unsigned int hash = 5381;
-    while (*key) {
-        hash = ((hash << 5) + hash) + *key++;
-    }
-    return hash % nbSlots;
+// Horloge monotone en secondes
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
 
-// Analyse du fichier et remplissage de la table de hachage
-t_hashtable* parseFileHash(const char* filename, t_metadata* metadata, int nbSlots, unsigned int (*hashFunc)(const char*, int)) {
+// Lecture d'un fichier de requêtes (un mot par ligne, lignes vides ignorées) :
+// le fichier est lu d'un bloc dans *text (à libérer avec le tableau renvoyé)
+// et découpé sur place, les requêtes pointent dans ce texte
+char** readQueries(const char* filename, char** text, int* nbQueries) {
     FILE* file = fopen(filename, "r");
     if (!file) {
-        perror("Erreur d'ouverture de fichier");
+        perror("Erreur d'ouverture du fichier de requêtes");
         exit(EXIT_FAILURE);
     }
-
-    t_hashtable* table = malloc(sizeof(t_hashtable));
-    assert(table != NULL);
-    table->slots = calloc(nbSlots, sizeof(t_node*));
-    assert(table->slots != NULL);
-    table->nbSlots = nbSlots;
-    table->nbTuples = 0;
-
-    metadata->sep = '\0';
-    metadata->nbFields = 0;
-    metadata->fieldNames = NULL;
-
-    char* line;
-    int step = 0;
-
-    while ((line = readLine(file)) != NULL) {
-
-        // Ignorer les commentaires
-        if (line[0] == '#' && strlen(line) > 1) {
-            free(line);
-            continue;
-        }
-
-        // Séparateur
-        if (step == 0) {
-            if (strlen(line) == 1) {
-                metadata->sep = line[0];
-                printf("Séparateur détecté : '%c'\n", metadata->sep);
-                free(line);
-                step++;
-                continue;
-            } else {
-                fprintf(stderr, "Erreur : séparateur invalide (doit être un caractère unique).\n");
-                free(line);
-                fclose(file);
-                exit(EXIT_FAILURE);
-            }
-        }
-
-        // Nombre de champs
-        if (step == 1) {
-            metadata->nbFields = atoi(line);
-            if (metadata->nbFields <= 0) {
-                fprintf(stderr, "Erreur : nombre de champs invalide : %s\n", line);
-                free(line);
-                fclose(file);
-                exit(EXIT_FAILURE);
-            }
-            metadata->fieldNames = malloc(metadata->nbFields * sizeof(char*));
-            assert(metadata->fieldNames != NULL);
-            for (int i = 0; i < metadata->nbFields; i++) {
-                metadata->fieldNames[i] = NULL;
-            }
-            printf("%d champs détectés.\n", metadata->nbFields);
-            free(line);
-            step++;
-            continue;
-        }
-
-        // Noms des champs
-        if (step == 2) {
-            char* token = strtok(line, &metadata->sep);
-            for (int i = 0; i < metadata->nbFields; i++) {
-                if (token != NULL) {
-                    metadata->fieldNames[i] = allocateField(token);
-                    token = strtok(NULL, &metadata->sep);
-                } else {
-                    metadata->fieldNames[i] = allocateField("");
-                }
-            }
-            printf("Noms des champs : ");
-            for (int i = 0; i < metadata->nbFields; i++) {
-                printf("%s%s", metadata->fieldNames[i], (i == metadata->nbFields - 1) ? "\n" : ", ");
-            }
-            free(line);
-            step++;
-            continue;
-        }
-
-        // Lecture et insertion des données
-        if (step >= 3) {
-            t_tuple tuple;
-            char* token = strtok(line, &metadata->sep);
-
-            // Lire la clé
-            if (token == NULL) {
-                fprintf(stderr, "Erreur : ligne mal formatée, clé manquante.\n");
-                free(line);
-                continue;
-            }
-            tuple.key = allocateField(token);
-
-            // Lire les valeurs associées
-            tuple.definitions = malloc(sizeof(char**));
-            assert(tuple.definitions != NULL);
-            tuple.definitions[0] = malloc((metadata->nbFields - 1) * sizeof(char*));
-            assert(tuple.definitions[0] != NULL);
-            for (int i = 0; i < metadata->nbFields - 1; i++) {
-                token = strtok(NULL, &metadata->sep);
-                tuple.definitions[0][i] = allocateField(token ? token : "");
-            }
-            tuple.nbDefinitions = 1;
-
-            // Insérer le tuple dans la table
-            insertTupleHash(table, &tuple, nbSlots, metadata, hashFunc);
-            free(line);
+    size_t size = 0, capacity = 64 * 1024;
+    *text = malloc(capacity + 1);
+    assert(*text != NULL);
+    size_t count;
+    while ((count = fread(*text + size, 1, capacity - size, file)) > 0) {
+        size += count;
+        if (size == capacity) {
+            capacity *= 2;
+            *text = realloc(*text, capacity + 1);
+            assert(*text != NULL);
         }
     }
-
     fclose(file);
-    return table;
-}
-
-// Insertion d'un tuple dans la table
-void insertTupleHash(t_hashtable* table, const t_tuple* tuple, int nbSlots, t_metadata* metadata, unsigned int (*hashFunc)(const char*, int)) {
-    unsigned int index = hashFunc(tuple->key, nbSlots);
-    t_node* current = table->slots[index];
-
-    while (current) {
-        if (strcmp(current->data.key, tuple->key) == 0) {
-            // Ajouter une nouvelle occurrence pour cette clé
-            current->data.nbDefinitions++;
-            current->data.definitions = realloc(current->data.definitions, current->data.nbDefinitions * sizeof(char**));
-            assert(current->data.definitions != NULL);
-            current->data.definitions[current->data.nbDefinitions - 1] = malloc((metadata->nbFields - 1) * sizeof(char*));
-            assert(current->data.definitions[current->data.nbDefinitions - 1] != NULL);
-            for (int i = 0; i < metadata->nbFields - 1; i++) {
-                current->data.definitions[current->data.nbDefinitions - 1][i] = allocateField(tuple->definitions[0][i]);
+    (*text)[size] = '\0';
+
+    int maxQueries = 1024;
+    char** queries = malloc(maxQueries * sizeof(char*));
+    assert(queries != NULL);
+    *nbQueries = 0;
+    for (char* line = *text; line < *text + size; ) {
+        char* end = memchr(line, '\n', *text + size - line);
+        if (!end) end = *text + size;
+        *end = '\0';
+        if (end > line) {
+            if (*nbQueries >= maxQueries) {
+                maxQueries *= 2;
+                queries = realloc(queries, maxQueries * sizeof(char*));
+                assert(queries != NULL);
             }
-            return;
+            queries[(*nbQueries)++] = line;
         }
-        current = current->next;
+        line = end + 1;
     }
+    return queries;
+}
 
-    // Si la clé n'existe pas, créer un nouveau nœud
-    t_node* newNode = malloc(sizeof(t_node));
-    assert(newNode != NULL);
-    newNode->data.key = allocateField(tuple->key);
-    newNode->data.definitions = malloc(sizeof(char**));
-    assert(newNode->data.definitions != NULL);
-    newNode->data.definitions[0] = malloc((metadata->nbFields - 1) * sizeof(char*));
-    assert(newNode->data.definitions[0] != NULL);
-    for (int i = 0; i < metadata->nbFields - 1; i++) {
-        newNode->data.definitions[0][i] = allocateField(tuple->definitions[0][i]);
+// Recherche de toutes les requêtes et bilan : temps total, débit, trouvés/absents,
+// comparaisons moyenne et maximale. En mode muet, seul le bilan est affiché.
+void runBatch(const t_frTable* table, char** queries, int nbQueries, int quiet) {
+    int found = 0;
+    int maxComparisons = 0;
+    long totalComparisons = 0;
+
+    double start = now();
+    for (int q = 0; q < nbQueries; q++) {
+        int comparisons;
+        const t_frEntry* entry = frLookup(table, queries[q], strlen(queries[q]), &comparisons);
+        if (!quiet) printSearchHash(table, queries[q], entry, comparisons);
+        if (entry) found++;
+        totalComparisons += comparisons;
+        if (comparisons > maxComparisons) maxComparisons = comparisons;
     }
-    newNode->data.nbDefinitions = 1;
-    newNode->next = table->slots[index];
-    table->slots[index] = newNode;
-    table->nbTuples++;
+    double elapsed = now() - start;
+
+    printf("%d requêtes en %.3f ms (%.0f recherches/s)\n", nbQueries, elapsed * 1000, elapsed > 0 ? nbQueries / elapsed : 0);
+    printf("  trouvés : %d, absents : %d\n", found, nbQueries - found);
+    printf("  comparaisons : moyenne %.2f, max %d\n", nbQueries > 0 ? (double)totalComparisons / nbQueries : 0, maxComparisons);
 }
 
-// Recherche d'une clé
-void searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int nbSlots, unsigned int (*hashFunc)(const char*, int)) {
-    unsigned int index = hashFunc(key, nbSlots);
-    t_node* current = table->slots[index];
-    int comparisons = 0;
-    int found = 0;
+// Ordre croissant de deux durées (tri des latences)
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
 
-    while (current) {
-        comparisons++;
-        if (strcmp(current->data.key, key) == 0) {
-            if (!found) {
-                printf("Recherche de %s : trouvé ! nb comparaisons : %d\n", key, comparisons);
-                found = 1;
-            }
-            printf("mot : %s\n", current->data.key);
-            for (int d = 0; d < current->data.nbDefinitions; d++) {
-                printf("Définition %d :\n", d + 1);
-                for (int j = 0; j < metadata->nbFields - 1; j++) {
-                    printf("  %s : %s\n", metadata->fieldNames[j + 1],
-                        strlen(current->data.definitions[d][j]) > 0 ? current->data.definitions[d][j] : "X");
-                }
-                printf("\n");
-            }
-        }
-        current = current->next;
-    }
-    if (!found) {
-        printf("Recherche de %s : échec ! nb comparaisons : %d\n", key, comparisons);
+// Ligne CSV d'un banc d'essai, mêmes colonnes que prog1 et prog3 (en-tête
+// écrit par make bench). La mémoire est le pic du processus (getrusage) ;
+// latencies est trié sur place.
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double total = 0;
+    for (int q = 0; q < nbQueries; q++) total += latencies[q];
+    qsort(latencies, nbQueries, sizeof(double), compareDoubles);
+    printf("prog2,%s,%s,%s,%d,%d,%d,%.3f,%ld", engine, tableFile, queryFile, nbKeys, nbQueries, found, buildTime * 1000, usage.ru_maxrss);
+    if (nbQueries > 0) {
+        printf(",%.0f,%.0f,%.0f,%.0f,%.0f\n", total * 1e9 / nbQueries, latencies[nbQueries / 2] * 1e9,
+            latencies[(int)(nbQueries * 0.9)] * 1e9, latencies[(int)(nbQueries * 0.99)] * 1e9, latencies[nbQueries - 1] * 1e9);
+    } else {
+        printf(",0,0,0,0,0\n");
     }
 }
 
-// Libération de la mémoire
-void freeHashTable(t_hashtable* table, t_metadata* metadata) {
-    for (int i = 0; i < table->nbSlots; i++) {
-        t_node* current = table->slots[i];
-        while (current) {
-            t_node* temp = current;
-            free(current->data.key);
-            for (int d = 0; d < current->data.nbDefinitions; d++) {
-                for (int j = 0; j < metadata->nbFields - 1; j++) {
-                    free(current->data.definitions[d][j]);
-                }
-                free(current->data.definitions[d]);
-            }
-            free(current->data.definitions);
-            current = current->next;
-            free(temp);
-        }
-    }
-    free(table->slots);
-    for (int i = 0; i < metadata->nbFields; i++) {
-        free(metadata->fieldNames[i]);
+// Latence de chaque recherche, sans affichage, puis la ligne CSV. Une seule
+// lecture d'horloge par requête : la fin d'une recherche est le début de la suivante.
+void csvReport(const t_frTable* table, const char* tableFile, const char* queryFile, char** queries, int nbQueries, double buildTime) {
+    double* latencies = malloc((nbQueries + 1) * sizeof(double));
+    assert(latencies != NULL);
+    int found = 0;
+    double previous = now();
+    for (int q = 0; q < nbQueries; q++) {
+        const t_frEntry* entry = frLookup(table, queries[q], strlen(queries[q]), NULL);
+        double end = now();
+        latencies[q] = end - previous;
+        previous = end;
+        if (entry) found++;
     }
-    free(metadata->fieldNames);
-    free(table);
-}
\ No newline at end of file
+    printCsvRow("chainage", tableFile, queryFile, frNbKeys(table), nbQueries, found, buildTime, latencies);
+    free(latencies);
+}
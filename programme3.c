@@ -2,15 +2,51 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "fr_commun.h"
 
 // Structures
+// Vue sur un champ : position et longueur dans le texte de la table.
+// Le texte est soit le fichier d'entrée projeté en mémoire (mmap), soit un
+// tampon où sont recopiées les lignes lues sur l'entrée standard.
 typedef struct {
-    char* key;
-    char*** definitions;
+    unsigned int offset;
+    unsigned int len;
+} t_view;
+
+// Définition creuse : bitmap des champs non vides (bit j : champ j+1, sur
+// fieldWords(nbFields) mots), suivie des vues de ces seuls champs, dans l'ordre.
+// Un champ vide ne coûte qu'un bit ; definitionField retrouve un champ.
+typedef struct {
+    t_view key;
+    uint64_t** definitions;  // definitions[d] : d-ième occurrence de la clé
     int nbDefinitions;
+    int capacity;            // Place allouée dans definitions (doublée quand elle est pleine)
 } t_tuple;
 
+// Clés courtes recopiées dans le nœud ou la case, à côté de l'empreinte (la
+// plupart des mots font moins de 16 octets) : une comparaison ne lit le texte
+// de la table, un défaut de cache de plus, que pour une clé longue.
+// -DINLINE_KEY_SIZE=0 rétablit l'ancienne disposition, pour comparaison.
+#ifndef INLINE_KEY_SIZE
+#define INLINE_KEY_SIZE 16
+#endif
+
 typedef struct node {
+#if INLINE_KEY_SIZE > 0
+    unsigned int hash;                // Hachage complet, comparé avant la clé
+    char inlineKey[INLINE_KEY_SIZE];  // Clé si key.len <= INLINE_KEY_SIZE
+#endif
     t_tuple data;
     struct node* next;
 } t_node;
@@ -21,26 +57,505 @@ typedef struct {
     char** fieldNames;
 } t_metadata;
 
+// Case de la table à adressage ouvert (Robin Hood, sondage linéaire)
+typedef struct {
+    unsigned int hash;   // Hachage complet de la clé, comparé avant la clé
+    unsigned int dist;   // Distance à la case d'origine + 1 (0 : case vide)
+    t_tuple data;
+#if INLINE_KEY_SIZE > 0
+    char inlineKey[INLINE_KEY_SIZE];
+#endif
+} t_entry;
+
+// Moteurs de table
+#define ENGINE_CHAINAGE 1   // Listes chaînées par alvéole
+#define ENGINE_ROBINHOOD 2  // Adressage ouvert, cases contiguës
+#define ENGINE_PARFAIT 3    // Hachage parfait minimal (table figée après chargement)
+
+// Hachage parfait (CHD, « hash and displace ») : les clés sont réparties en
+// seaux de PERFECT_BUCKET_SIZE clés en moyenne ; chaque seau reçoit un
+// déplacement qui envoie toutes ses clés dans des cases libres. Une recherche
+// lit un déplacement et une case, et compare une seule clé.
+#define PERFECT_BUCKET_SIZE 4
+#define PERFECT_MAX_SEEDS 16
+
+// Filtre de Bloom (-f<taux>) : consulté avant de sonder la table, il écarte
+// la plupart des clés absentes sans parcourir de liste ni de cases. Dimensionné
+// après le chargement pour le taux de faux positifs demandé :
+// m = -n ln(taux) / ln(2)² bits et k = (m / n) ln(2) positions par clé.
+// Les k positions d'une clé tombent dans un même bloc de 512 bits (une ligne de
+// cache) : un seul défaut de cache par recherche, pour un taux à peine plus élevé.
+#define BLOOM_MAX_HASHES 16
+#define BLOOM_BLOCK_WORDS 8
+
+// Agrandissement automatique : la table double quand nbTuples dépasse
+// maxLoad * nbSlots. En chaînage, les anciennes alvéoles sont migrées
+// REHASH_STEP par REHASH_STEP à chaque insertion (aucune pause de rehachage).
+#define DEFAULT_NB_SLOTS 1024
+#define DEFAULT_LOAD_CHAINAGE 1.0
+#define DEFAULT_LOAD_ROBINHOOD 0.9
+#define REHASH_STEP 2
+
+// Fonctions de hachage : hachage complet sur 64 bits, replié sur 32 bits par
+// la table puis réduit au nombre d'alvéoles (masque si c'est une puissance de 2)
+typedef uint64_t (*hashFunction)(const char* key, size_t len);
+
+typedef struct {
+    const char* name;
+    hashFunction func;
+    const char* description;
+} t_hashInfo;
+
+// Normalisation des clés (-n), appliquée au chargement et aux requêtes pour que
+// deux écritures d'un même mot désignent la même clé. La forme NFC recompose
+// les lettres latines suivies d'un diacritique combinant (e + U+0301 -> é) ;
+// les pliages retirent les accents (é -> e, œ -> oe) ou passent en minuscules.
+// Une clé normalisée n'est jamais plus longue : elle est réécrite sur place.
+#define NORMALISATION_AUCUNE 0
+#define NORMALISATION_NFC 1
+#define NORMALISATION_ACCENTS 2
+#define NORMALISATION_CASSE 4
+
+typedef struct {
+    const char* name;
+    int mode;            // NORMALISATION_NFC combinée aux pliages
+    const char* description;
+} t_normalizationInfo;
+
+// Lettre latine précomposée : base ASCII + diacritique combinant (U+0300 à U+036F)
 typedef struct {
-    t_node** slots;
+    char base;
+    uint16_t mark;
+    uint16_t composed;
+} t_composition;
+
+// Lettres latines de U+00C0 à U+017F (Latin-1 et Latin étendu A)
+#define LATIN_FIRST 0xC0
+#define LATIN_COUNT 0xC0
+
+// Table concurrente (chaînage) : les alvéoles sont publiées d'un bloc avec leur
+// nombre, un lecteur ne voit jamais un tableau avec la taille d'un autre
+typedef struct {
+    int nbSlots;
+    t_node* slots[];
+} t_slotArray;
+
+// Texte d'une table concurrente lue sur un flux : l'espace d'adressage maximal
+// des vues est réservé d'emblée (pages allouées à l'écriture), le texte n'est
+// jamais déplacé sous les lecteurs
+#define TEXT_RESERVATION ((size_t)UINT_MAX)
+
+typedef struct {
+    int engine;          // ENGINE_CHAINAGE, ENGINE_ROBINHOOD ou ENGINE_PARFAIT
+    hashFunction hashFunc;
+    t_node** slots;      // Chaînage : une liste par alvéole
+    t_node** oldSlots;   // Chaînage : alvéoles en cours de migration (NULL sinon)
+    int oldNbSlots;
+    int rehashIndex;     // Prochaine ancienne alvéole à migrer
+    t_entry* entries;    // Robin Hood : nbSlots cases
     int nbSlots;
     int nbTuples;
+    double maxLoad;      // Taux de remplissage déclenchant l'agrandissement
+    int verbose;         // Affichage des informations de chargement
+    t_arena* arena;      // Propriétaire des nœuds et des tableaux de vues
+    char* text;          // Texte référencé par les vues
+    size_t textSize;     // Octets utilisés
+    size_t textCapacity; // Octets alloués (0 si text est projeté par mmap)
+    int concurrent;      // Recherches possibles pendant les insertions (enableConcurrency)
+    t_slotArray* shared; // Concurrent : alvéoles publiées (slots et nbSlots en sont la copie)
+    pthread_mutex_t writeLock; // Concurrent : une insertion à la fois
+    uint32_t* displacements;   // Parfait : déplacement de chaque seau (dans l'arène)
+    uint32_t nbBuckets;
+    uint32_t perfectSeed;      // Parfait : graine du hachage de construction
+    int normalization;         // NORMALISATION_* appliquée aux clés et aux requêtes
+    uint64_t* bloom;           // Filtre de Bloom (NULL sans -f)
+    uint64_t bloomBits;
+    int bloomHashes;
 } t_hashtable;
 
-typedef unsigned int (*hashFunction)(const char* key, int nbSlots);
+// Index trié des clés (-trie, -a) : arbre radix compact construit après le
+// chargement, où les préfixes communs ne sont rangés qu'une fois. Les nœuds
+// sont en ordre préfixe : les descendants du nœud i occupent [i + 1, end[, son
+// premier enfant est i + 1 et chaque enfant est suivi de son frère à son end.
+// Les clés d'un préfixe forment donc une plage de nœuds, dans l'ordre des octets.
+#define TRIE_NO_TUPLE UINT32_MAX
+
+typedef struct {
+    uint32_t label;      // Début de l'étiquette dans labels
+    uint32_t labelLen;
+    uint32_t end;        // Fin du sous-arbre
+    uint32_t tuple;      // Indice de la clé qui se termine ici, TRIE_NO_TUPLE sinon
+} t_trieNode;
+
+typedef struct {
+    t_trieNode* nodes;
+    uint32_t nbNodes;
+    uint32_t capacity;
+    char* labels;        // Étiquettes bout à bout
+    size_t labelsSize;
+    size_t labelsCapacity;
+    t_tuple* tuples;     // Tuples dans l'ordre des clés
+    uint32_t nbTuples;
+    uint32_t maxKeyLen;  // Profondeur maximale (lignes de la recherche approchée)
+} t_trie;
+
+// Clé à ranger dans l'arbre (tri préalable par ordre des octets)
+typedef struct {
+    const char* text;
+    uint32_t len;
+    uint32_t tuple;
+} t_trieKey;
+
+// Recherche approchée (-d<distance>) : clés à distance d'édition (Levenshtein,
+// en octets) au plus maxDistance d'une requête absente. L'arbre est parcouru en
+// profondeur avec une ligne de la matrice de distance par octet descendu ; une
+// branche est abandonnée dès que toute sa ligne dépasse maxDistance.
+#define DEFAULT_NB_SUGGESTIONS 3
+
+typedef struct {
+    uint32_t tuple;      // Indice dans trie->tuples
+    int distance;
+} t_suggestion;
+
+typedef struct {
+    const t_trie* trie;
+    const char* key;
+    size_t len;
+    int maxDistance;
+    int* rows;           // (maxKeyLen + 1) lignes de len + 1 distances
+    t_suggestion* found;
+    int nbFound;
+    int capacity;
+} t_fuzzySearch;
+
+// Instantané binaire d'une table construite (-b -o<fichier>), rechargé par mmap
+// sans analyse ni rehachage. Toutes les positions sont des décalages depuis le
+// début du fichier, qui sert directement de texte à la table :
+//   en-tête | enregistrements | définitions creuses | déplacements (parfait)
+//   | vues des noms de champs | chaînes
+#define SNAPSHOT_MAGIC "FRHT"
+#define SNAPSHOT_VERSION 3
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    char sep;
+    char normalization;         // Normalisation des clés (requêtes à normaliser de même)
+    char padding[2];
+    uint32_t nbFields;
+    uint32_t hashId;            // Indice (à partir de 1) dans hashFunctions
+    uint32_t engine;
+    uint32_t nbSlots;
+    uint32_t nbTuples;
+    uint32_t definitionsSize;   // Octets des définitions (bitmaps et vues)
+    uint32_t nbBuckets;         // Parfait : nombre de déplacements (0 sinon)
+    uint32_t perfectSeed;
+    uint32_t recordsOffset;
+    uint32_t definitionsOffset;
+    uint32_t fieldNamesOffset;
+    uint32_t poolOffset;
+    uint32_t fileSize;
+} t_snapshotHeader;
+
+// Un tuple : sa position dans la table et sa clé (ses définitions creuses se
+// suivent, dans l'ordre des enregistrements)
+typedef struct {
+    uint32_t slot;      // Alvéole (chaînage) ou case (robinhood, parfait)
+    uint32_t hash;      // Hachage replié de la clé
+    uint32_t dist;      // Robinhood : distance + 1 (0 en chaînage)
+    uint32_t nbDefinitions;
+    t_view key;
+} t_snapshotRecord;
+
+// Sections écrites par saveSnapshotTuple, une par parcours de la table
+#define SNAPSHOT_COUNT 0    // Taille des définitions
+#define SNAPSHOT_RECORDS 1
+#define SNAPSHOT_VIEWS 2
+#define SNAPSHOT_STRINGS 3
+
+typedef struct {
+    FILE* output;
+    t_metadata* metadata;
+    uint32_t pool;              // Décalage de la prochaine chaîne dans le fichier
+    int pass;
+    uint32_t definitionsSize;
+} t_snapshotWriter;
+
+// Recherche par lot : une tranche [begin, end[ des requêtes et ses compteurs.
+// En parallèle, chaque tranche écrit dans son propre tampon (open_memstream),
+// concaténés ensuite dans l'ordre des tranches, donc des requêtes.
+#define MAX_THREADS 64
+typedef struct {
+    t_hashtable* table;   // Lecture seule pendant les recherches
+    t_metadata* metadata;
+    char** queries;
+    int begin;
+    int end;
+    int quiet;
+    char* buffer;         // Sortie de la tranche (NULL en mode muet)
+    size_t bufferSize;
+    int found;
+    int maxComparisons;
+    int maxProbes;
+    long totalComparisons;
+    long totalProbes;
+    int rejected;         // Absents écartés par le filtre de Bloom, sans sondage
+    int falsePositives;   // Absents acceptés par le filtre (sondés pour rien)
+} t_batch;
+
+// Chargement parallèle : le corps du fichier (après l'en-tête) est découpé en
+// tranches de lignes entières, analysées chacune par un thread dans sa propre
+// arène (découpage, hachage, définition creuse). Les tuples sont ensuite
+// insérés dans l'ordre des tranches, donc des lignes, avec leur hachage.
+typedef struct {
+    t_view key;
+    unsigned int hash;
+    uint64_t* definition;
+} t_parsedLine;
+
+typedef struct {
+    t_hashtable* table;     // Lecture seule : texte et fonction de hachage
+    t_metadata* metadata;
+    size_t begin;           // Début d'une ligne
+    size_t end;             // Début de la ligne suivant la tranche (ou fin du texte)
+    t_arena* arena;         // Définitions de la tranche, rattachées ensuite à la table
+    t_parsedLine* lines;
+    int nbLines;
+    int capacity;
+    int stopped;            // Ligne vide rencontrée : fin des données
+} t_loadChunk;
+
+// Charge mixte : un thread charge le fichier dans une table concurrente pendant
+// que des lecteurs recherchent les requêtes en boucle jusqu'à la fin du chargement
+typedef struct {
+    t_hashtable* table;
+    t_metadata* metadata;
+    const char* filename;
+    int done;               // Lu et écrit de façon atomique
+} t_loader;
+
+typedef struct {
+    t_hashtable* table;
+    char** queries;
+    int nbQueries;
+    const int* done;
+    long lookups;
+    long found;
+} t_reader;
 
 // Prototypes
-char* readLine(FILE* file);
-char* allocateField(const char* source);
-t_hashtable* parseFileHash(FILE* inputFile, t_metadata* metadata, int nbSlots, hashFunction hashFunc);
-void insertTupleHash(t_hashtable* table, const t_tuple* tuple, int nbSlots, t_metadata* metadata, hashFunction hashFunc);
-void searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int nbSlots, hashFunction hashFunc);
-unsigned int hashFunction1(const char* key, int nbSlots);
-unsigned int hashFunction2(const char* key, int nbSlots);
+const char* fieldText(const t_hashtable* table, t_view field);
+int splitViews(const char* text, size_t start, size_t end, char sep, t_view* fields, int nbFields);
+size_t appendText(t_hashtable* table, const char* line, size_t len);
+t_hashtable* createHashTable(int engine, int nbSlots, hashFunction hashFunc);
+t_slotArray* createSlotArray(t_arena* arena, int nbSlots);
+void enableConcurrency(t_hashtable* table);
+unsigned int foldHash(uint64_t hash);
+unsigned int hashKey(const t_hashtable* table, const char* key, size_t len);
+unsigned int slotIndex(unsigned int hash, int nbSlots);
+void startRehash(t_hashtable* table);
+void rehashStep(t_hashtable* table, int nbBuckets);
+void completeRehash(t_hashtable* table);
+int parseLineHash(t_hashtable* table, t_metadata* metadata, int* step, size_t start, size_t end);
+void parseFileHash(FILE* inputFile, t_metadata* metadata, t_hashtable* table);
+void parseFileHashMmap(const char* filename, t_metadata* metadata, t_hashtable* table, int nbThreads);
+void* loadChunkWorker(void* arg);
+void parseBodyParallel(t_hashtable* table, t_metadata* metadata, size_t start, int nbThreads);
+void loadScalingReport(const char* filename, int engine, int nbSlots, hashFunction hashFunc, double maxLoad, int normalization, const int* threadCounts, int nbCounts);
+int keyEquals(const t_hashtable* table, t_view key, const char* other, size_t len);
+int storedKeyEquals(const t_hashtable* table, const char* inlineKey, t_view key, const char* other, size_t len);
+void copyInlineKey(const t_hashtable* table, char* inlineKey, t_view key);
+void setNodeKey(const t_hashtable* table, t_node* node, unsigned int hash);
+unsigned int nodeHash(const t_hashtable* table, const t_node* node);
+int nodeMatches(const t_hashtable* table, const t_node* node, const char* key, size_t len, unsigned int hash, int* comparisons);
+void setEntryKey(const t_hashtable* table, t_entry* entry);
+int entryKeyEquals(const t_hashtable* table, const t_entry* entry, const char* key, size_t len);
+int fieldWords(int nbFields);
+int definitionCount(const uint64_t* definition, int nbFields);
+t_view definitionField(const uint64_t* definition, int nbFields, int field);
+uint64_t* packDefinition(t_arena* arena, const t_view* fields, int nbFields);
+t_tuple* lookupHash(t_hashtable* table, const char* key, size_t len, unsigned int hash, int* comparisons, int* probes);
+t_tuple* probeTable(t_hashtable* table, const char* key, size_t len, unsigned int hash, int* comparisons, int* probes);
+void addBloomKey(t_hashtable* table, const t_tuple* tuple, void* context);
+void buildBloomFilter(t_hashtable* table, double rate);
+int bloomMayContain(const t_hashtable* table, const char* key, size_t len);
+void insertRobinHood(t_hashtable* table, t_entry entry);
+void growRobinHood(t_hashtable* table);
+void insertTupleHash(t_hashtable* table, const t_tuple* tuple, t_metadata* metadata);
+void insertTupleHashed(t_hashtable* table, const t_tuple* tuple, unsigned int hash);
+void appendDefinition(t_arena* arena, t_tuple* tuple, uint64_t* definition);
+void insertConcurrent(t_hashtable* table, const t_tuple* tuple, unsigned int hash);
+void growConcurrent(t_hashtable* table);
+uint64_t perfectKeyHash(const char* key, size_t len, uint32_t seed);
+uint32_t perfectBucket(uint64_t hash, uint32_t nbBuckets);
+uint32_t perfectPosition(uint64_t hash, uint32_t displacement, uint32_t nbSlots);
+int placePerfectKeys(t_hashtable* table, const t_tuple* tuples, uint32_t n, uint32_t seed, uint32_t* displacements, uint32_t* positions);
+void collectTuple(t_hashtable* table, const t_tuple* tuple, void* context);
+void buildPerfectHash(t_hashtable* table);
+const char* engineName(int engine);
+int compareTrieKeys(const void* a, const void* b);
+uint32_t addTrieNode(t_trie* trie, const char* label, uint32_t labelLen);
+void buildTrieNode(t_trie* trie, const t_trieKey* keys, uint32_t begin, uint32_t end, uint32_t depth);
+t_trie* buildTrie(t_hashtable* table);
+void freeTrie(t_trie* trie);
+const t_tuple* lookupTrie(const t_trie* trie, const char* key, size_t len, int* comparisons, int* probes);
+uint32_t findTriePrefix(const t_trie* trie, const char* prefix, size_t len, uint32_t* length);
+int completeTrie(const t_trie* trie, const char* prefix, size_t len, int maxResults, uint32_t* results);
+void printCompletions(const t_trie* trie, t_hashtable* table, const char* prefix, int maxResults);
+void trieReport(const t_trie* trie, t_hashtable* table, double buildTime);
+void runTrieBatch(const t_trie* trie, t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet);
+void fuzzyVisit(t_fuzzySearch* search, uint32_t index, uint32_t depth);
+int compareSuggestions(const void* a, const void* b);
+int compareDoubles(const void* a, const void* b);
+int suggestTrie(const t_trie* trie, const char* key, size_t len, int maxDistance, int maxResults, t_suggestion* results);
+void printSuggestions(const t_trie* trie, t_hashtable* table, FILE* output, const char* key, int maxDistance, int maxResults);
+void suggestionReport(const t_trie* trie, t_hashtable* table, char** queries, int nbQueries, int quiet, int maxDistance, int maxResults);
+void printTuple(t_hashtable* table, FILE* output, t_metadata* metadata, const t_tuple* tuple);
+void printSearchResult(t_hashtable* table, FILE* output, t_metadata* metadata, const char* key, const t_tuple* tuple, int comparisons, int probes);
+int searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int* comparisons, int* probes);
+double averageProbeLength(t_hashtable* table);
+char** readQueries(const char* filename, t_arena* arena, int* nbQueries);
+void searchBatch(t_batch* batch, FILE* output);
+void printBatchSummary(const t_batch* batch, int nbQueries, double elapsed);
+void runBatch(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet);
+void* batchWorker(void* arg);
+double runParallelBatch(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet, int nbThreads, int printResults);
+void parallelScalingReport(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet, const int* threadCounts, int nbCounts);
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies);
+void csvReport(t_hashtable* table, const t_trie* trie, const char* tableFile, const char* queryFile, char** queries, int nbQueries, double buildTime);
+void* loaderThread(void* arg);
+void* readerThread(void* arg);
+void mixedWorkloadReport(const char* filename, int nbSlots, hashFunction hashFunc, double maxLoad, int normalization, char** queries, int nbQueries, const int* readerCounts, int nbCounts);
+int parseThreadList(const char* list, int* counts, int minimum);
+uint64_t hashFunction1(const char* key, size_t len);
+uint64_t hashFunction2(const char* key, size_t len);
+uint64_t hashFnv1a(const char* key, size_t len);
+uint64_t hashMix64(const char* key, size_t len);
+int findHashFunction(const char* name);
+int findNormalization(const char* name);
+const char* normalizationName(int mode);
+long decodeUtf8(const unsigned char* text, size_t len, size_t* size);
+unsigned int composeLatin(unsigned int base, unsigned int mark);
+size_t putCodePoint(char* out, size_t position, int inPlace, unsigned int codePoint);
+const char* normalizeKey(int mode, const char* key, size_t* len, char* out);
+void normalizeField(t_hashtable* table, t_view* field);
+double now(void);
+void iterateHashTable(t_hashtable* table, void (*visit)(t_hashtable*, const t_tuple*, void*), void* context);
+void collectKeys(t_hashtable* table, t_view* keys);
+void printStats(t_hashtable* table, t_metadata* metadata, const char* inputFile, const char* hashName, double buildTime);
+void hashQualityReport(t_hashtable* table);
 void freeHashTable(t_hashtable* table, t_metadata* metadata);
 void saveHashTableToFile(t_hashtable* table, FILE* output, t_metadata* metadata);
+void saveTuple(t_hashtable* table, FILE* output, t_metadata* metadata, const t_tuple* tuple);
+int isSnapshot(const char* filename);
+void saveSnapshotTuple(t_hashtable* table, const t_tuple* tuple, void* context);
+void saveSnapshot(t_hashtable* table, FILE* output, t_metadata* metadata, int hashId);
+t_hashtable* loadSnapshot(const char* filename, t_metadata* metadata, int* hashId);
+int viewInside(t_view view, size_t size);
+void invalidSnapshot(const char* filename);
 void afficherAide();
 
+// Registre des fonctions de hachage, choisies par -h<numéro> ou -h<nom>
+t_hashInfo hashFunctions[] = {
+    { "somme31", hashFunction1, "h = 31 * h + c (fonction 1)" },
+    { "djb2",    hashFunction2, "h = 33 * h + c, h0 = 5381 (fonction 2)" },
+    { "fnv1a",   hashFnv1a,     "FNV-1a 64 bits" },
+    { "mix64",   hashMix64,     "mots de 8 octets et mélange 64 bits (style wyhash)" },
+};
+#define NB_HASH_FUNCTIONS (int)(sizeof(hashFunctions) / sizeof(hashFunctions[0]))
+
+// Registre des normalisations, choisies par -n<nom>
+t_normalizationInfo normalizations[] = {
+    { "nfc",     NORMALISATION_NFC, "forme NFC des lettres latines (défaut)" },
+    { "accents", NORMALISATION_NFC | NORMALISATION_ACCENTS, "NFC, puis accents retirés (é -> e, œ -> oe)" },
+    { "casse",   NORMALISATION_NFC | NORMALISATION_CASSE, "NFC, puis minuscules" },
+    { "tout",    NORMALISATION_NFC | NORMALISATION_ACCENTS | NORMALISATION_CASSE, "NFC, sans accents et en minuscules" },
+    { "aucune",  NORMALISATION_AUCUNE, "clés comparées octet par octet" },
+};
+#define NB_NORMALIZATIONS (int)(sizeof(normalizations) / sizeof(normalizations[0]))
+
+// Compositions NFC des lettres de U+00C0 à U+017F, triées par base puis diacritique
+const t_composition compositions[] = {
+    {'A', 0x300, 0x0C0}, {'A', 0x301, 0x0C1}, {'A', 0x302, 0x0C2}, {'A', 0x303, 0x0C3},
+    {'A', 0x304, 0x100}, {'A', 0x306, 0x102}, {'A', 0x308, 0x0C4}, {'A', 0x30A, 0x0C5},
+    {'A', 0x328, 0x104}, {'C', 0x301, 0x106}, {'C', 0x302, 0x108}, {'C', 0x307, 0x10A},
+    {'C', 0x30C, 0x10C}, {'C', 0x327, 0x0C7}, {'D', 0x30C, 0x10E}, {'E', 0x300, 0x0C8},
+    {'E', 0x301, 0x0C9}, {'E', 0x302, 0x0CA}, {'E', 0x304, 0x112}, {'E', 0x306, 0x114},
+    {'E', 0x307, 0x116}, {'E', 0x308, 0x0CB}, {'E', 0x30C, 0x11A}, {'E', 0x328, 0x118},
+    {'G', 0x302, 0x11C}, {'G', 0x306, 0x11E}, {'G', 0x307, 0x120}, {'G', 0x327, 0x122},
+    {'H', 0x302, 0x124}, {'I', 0x300, 0x0CC}, {'I', 0x301, 0x0CD}, {'I', 0x302, 0x0CE},
+    {'I', 0x303, 0x128}, {'I', 0x304, 0x12A}, {'I', 0x306, 0x12C}, {'I', 0x307, 0x130},
+    {'I', 0x308, 0x0CF}, {'I', 0x328, 0x12E}, {'J', 0x302, 0x134}, {'K', 0x327, 0x136},
+    {'L', 0x301, 0x139}, {'L', 0x30C, 0x13D}, {'L', 0x327, 0x13B}, {'N', 0x301, 0x143},
+    {'N', 0x303, 0x0D1}, {'N', 0x30C, 0x147}, {'N', 0x327, 0x145}, {'O', 0x300, 0x0D2},
+    {'O', 0x301, 0x0D3}, {'O', 0x302, 0x0D4}, {'O', 0x303, 0x0D5}, {'O', 0x304, 0x14C},
+    {'O', 0x306, 0x14E}, {'O', 0x308, 0x0D6}, {'O', 0x30B, 0x150}, {'R', 0x301, 0x154},
+    {'R', 0x30C, 0x158}, {'R', 0x327, 0x156}, {'S', 0x301, 0x15A}, {'S', 0x302, 0x15C},
+    {'S', 0x30C, 0x160}, {'S', 0x327, 0x15E}, {'T', 0x30C, 0x164}, {'T', 0x327, 0x162},
+    {'U', 0x300, 0x0D9}, {'U', 0x301, 0x0DA}, {'U', 0x302, 0x0DB}, {'U', 0x303, 0x168},
+    {'U', 0x304, 0x16A}, {'U', 0x306, 0x16C}, {'U', 0x308, 0x0DC}, {'U', 0x30A, 0x16E},
+    {'U', 0x30B, 0x170}, {'U', 0x328, 0x172}, {'W', 0x302, 0x174}, {'Y', 0x301, 0x0DD},
+    {'Y', 0x302, 0x176}, {'Y', 0x308, 0x178}, {'Z', 0x301, 0x179}, {'Z', 0x307, 0x17B},
+    {'Z', 0x30C, 0x17D}, {'a', 0x300, 0x0E0}, {'a', 0x301, 0x0E1}, {'a', 0x302, 0x0E2},
+    {'a', 0x303, 0x0E3}, {'a', 0x304, 0x101}, {'a', 0x306, 0x103}, {'a', 0x308, 0x0E4},
+    {'a', 0x30A, 0x0E5}, {'a', 0x328, 0x105}, {'c', 0x301, 0x107}, {'c', 0x302, 0x109},
+    {'c', 0x307, 0x10B}, {'c', 0x30C, 0x10D}, {'c', 0x327, 0x0E7}, {'d', 0x30C, 0x10F},
+    {'e', 0x300, 0x0E8}, {'e', 0x301, 0x0E9}, {'e', 0x302, 0x0EA}, {'e', 0x304, 0x113},
+    {'e', 0x306, 0x115}, {'e', 0x307, 0x117}, {'e', 0x308, 0x0EB}, {'e', 0x30C, 0x11B},
+    {'e', 0x328, 0x119}, {'g', 0x302, 0x11D}, {'g', 0x306, 0x11F}, {'g', 0x307, 0x121},
+    {'g', 0x327, 0x123}, {'h', 0x302, 0x125}, {'i', 0x300, 0x0EC}, {'i', 0x301, 0x0ED},
+    {'i', 0x302, 0x0EE}, {'i', 0x303, 0x129}, {'i', 0x304, 0x12B}, {'i', 0x306, 0x12D},
+    {'i', 0x308, 0x0EF}, {'i', 0x328, 0x12F}, {'j', 0x302, 0x135}, {'k', 0x327, 0x137},
+    {'l', 0x301, 0x13A}, {'l', 0x30C, 0x13E}, {'l', 0x327, 0x13C}, {'n', 0x301, 0x144},
+    {'n', 0x303, 0x0F1}, {'n', 0x30C, 0x148}, {'n', 0x327, 0x146}, {'o', 0x300, 0x0F2},
+    {'o', 0x301, 0x0F3}, {'o', 0x302, 0x0F4}, {'o', 0x303, 0x0F5}, {'o', 0x304, 0x14D},
+    {'o', 0x306, 0x14F}, {'o', 0x308, 0x0F6}, {'o', 0x30B, 0x151}, {'r', 0x301, 0x155},
+    {'r', 0x30C, 0x159}, {'r', 0x327, 0x157}, {'s', 0x301, 0x15B}, {'s', 0x302, 0x15D},
+    {'s', 0x30C, 0x161}, {'s', 0x327, 0x15F}, {'t', 0x30C, 0x165}, {'t', 0x327, 0x163},
+    {'u', 0x300, 0x0F9}, {'u', 0x301, 0x0FA}, {'u', 0x302, 0x0FB}, {'u', 0x303, 0x169},
+    {'u', 0x304, 0x16B}, {'u', 0x306, 0x16D}, {'u', 0x308, 0x0FC}, {'u', 0x30A, 0x16F},
+    {'u', 0x30B, 0x171}, {'u', 0x328, 0x173}, {'w', 0x302, 0x175}, {'y', 0x301, 0x0FD},
+    {'y', 0x302, 0x177}, {'y', 0x308, 0x0FF}, {'z', 0x301, 0x17A}, {'z', 0x307, 0x17C},
+    {'z', 0x30C, 0x17E},
+};
+
+// Lettres sans accent (pliage -naccents) ; vide : lettre gardée telle quelle
+const char latinBase[LATIN_COUNT][3] = {
+    "A", "A", "A", "A", "A", "A", "AE", "C", "E", "E", "E", "E", "I", "I", "I", "I",
+    "D", "N", "O", "O", "O", "O", "O", "", "O", "U", "U", "U", "U", "Y", "TH", "ss",
+    "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "y",
+    "A", "a", "A", "a", "A", "a", "C", "c", "C", "c", "C", "c", "C", "c", "D", "d",
+    "D", "d", "E", "e", "E", "e", "E", "e", "E", "e", "E", "e", "G", "g", "G", "g",
+    "G", "g", "G", "g", "H", "h", "H", "h", "I", "i", "I", "i", "I", "i", "I", "i",
+    "I", "i", "IJ", "ij", "J", "j", "K", "k", "", "L", "l", "L", "l", "L", "l", "L",
+    "l", "L", "l", "N", "n", "N", "n", "N", "n", "n", "", "", "O", "o", "O", "o",
+    "O", "o", "OE", "oe", "R", "r", "R", "r", "R", "r", "S", "s", "S", "s", "S", "s",
+    "S", "s", "T", "t", "T", "t", "T", "t", "U", "u", "U", "u", "U", "u", "U", "u",
+    "U", "u", "U", "u", "W", "w", "Y", "y", "Y", "Z", "z", "Z", "z", "Z", "z", "s",
+};
+
+// Minuscules (pliage -ncasse)
+const uint16_t latinLower[LATIN_COUNT] = {
+    0x0E0, 0x0E1, 0x0E2, 0x0E3, 0x0E4, 0x0E5, 0x0E6, 0x0E7, 0x0E8, 0x0E9, 0x0EA, 0x0EB,
+    0x0EC, 0x0ED, 0x0EE, 0x0EF, 0x0F0, 0x0F1, 0x0F2, 0x0F3, 0x0F4, 0x0F5, 0x0F6, 0x0D7,
+    0x0F8, 0x0F9, 0x0FA, 0x0FB, 0x0FC, 0x0FD, 0x0FE, 0x0DF, 0x0E0, 0x0E1, 0x0E2, 0x0E3,
+    0x0E4, 0x0E5, 0x0E6, 0x0E7, 0x0E8, 0x0E9, 0x0EA, 0x0EB, 0x0EC, 0x0ED, 0x0EE, 0x0EF,
+    0x0F0, 0x0F1, 0x0F2, 0x0F3, 0x0F4, 0x0F5, 0x0F6, 0x0F7, 0x0F8, 0x0F9, 0x0FA, 0x0FB,
+    0x0FC, 0x0FD, 0x0FE, 0x0FF, 0x101, 0x101, 0x103, 0x103, 0x105, 0x105, 0x107, 0x107,
+    0x109, 0x109, 0x10B, 0x10B, 0x10D, 0x10D, 0x10F, 0x10F, 0x111, 0x111, 0x113, 0x113,
+    0x115, 0x115, 0x117, 0x117, 0x119, 0x119, 0x11B, 0x11B, 0x11D, 0x11D, 0x11F, 0x11F,
+    0x121, 0x121, 0x123, 0x123, 0x125, 0x125, 0x127, 0x127, 0x129, 0x129, 0x12B, 0x12B,
+    0x12D, 0x12D, 0x12F, 0x12F, 0x069, 0x131, 0x133, 0x133, 0x135, 0x135, 0x137, 0x137,
+    0x138, 0x13A, 0x13A, 0x13C, 0x13C, 0x13E, 0x13E, 0x140, 0x140, 0x142, 0x142, 0x144,
+    0x144, 0x146, 0x146, 0x148, 0x148, 0x149, 0x14B, 0x14B, 0x14D, 0x14D, 0x14F, 0x14F,
+    0x151, 0x151, 0x153, 0x153, 0x155, 0x155, 0x157, 0x157, 0x159, 0x159, 0x15B, 0x15B,
+    0x15D, 0x15D, 0x15F, 0x15F, 0x161, 0x161, 0x163, 0x163, 0x165, 0x165, 0x167, 0x167,
+    0x169, 0x169, 0x16B, 0x16B, 0x16D, 0x16D, 0x16F, 0x16F, 0x171, 0x171, 0x173, 0x173,
+    0x175, 0x175, 0x177, 0x177, 0x0FF, 0x17A, 0x17A, 0x17C, 0x17C, 0x17E, 0x17E, 0x17F,
+};
+#define NB_COMPOSITIONS (int)(sizeof(compositions) / sizeof(compositions[0]))
+
 int main(int argc, char* argv[]) {
     if (argc == 2 && strcmp(argv[1], "-help") == 0) {
         afficherAide();
@@ -49,8 +564,30 @@ int main(int argc, char* argv[]) {
 
     const char* inputFile = NULL;
     const char* outputFile = NULL;
-    int nbSlots = -1;
+    int nbSlots = DEFAULT_NB_SLOTS;
     int hashFunctionChoice = -1;
+    int powerOfTwo = 0;
+    int hashReport = 0;
+    int statsMode = 0;
+    double maxLoad = 0;
+    double bloomRate = 0;
+    int normalization = -1;
+    int trieMode = 0;
+    const char* completionPrefix = NULL;
+    int nbCompletions = 0;
+    int maxDistance = 0;
+    int engine = ENGINE_CHAINAGE;
+    int searchMode = 0;
+    const char* queryFile = NULL;
+    int quiet = 0;
+    int csvMode = 0;
+    int threadCounts[MAX_THREADS];
+    int nbThreadCounts = 0;
+    int binaryOutput = 0;
+    int loadCounts[MAX_THREADS];
+    int nbLoadCounts = 0;
+    int readerCounts[MAX_THREADS];
+    int nbReaderCounts = 0;
 
     // Analyse des arguments
     for (int i = 1; i < argc; i++) {
@@ -58,62 +595,288 @@ int main(int argc, char* argv[]) {
             inputFile = argv[i] + 2;
         } else if (strncmp(argv[i], "-o", 2) == 0) {
             outputFile = argv[i] + 2;
-        } else if (strncmp(argv[i], "-s", 2) == 0) {
+        } else if (strncmp(argv[i], "-s", 2) == 0 && strcmp(argv[i], "-stats") != 0) {
             nbSlots = atoi(argv[i] + 2);
             if (nbSlots <= 0) {
                 fprintf(stderr, "Erreur : nombre d'alvéoles invalide.\n");
                 return EXIT_FAILURE;
             }
         } else if (strncmp(argv[i], "-h", 2) == 0) {
-            hashFunctionChoice = atoi(argv[i] + 2);
+            hashFunctionChoice = findHashFunction(argv[i] + 2);
             if (hashFunctionChoice < 1) {
-                fprintf(stderr, "Erreur : numéro de fonction de hachage invalide.\n");
+                fprintf(stderr, "Erreur : fonction de hachage inconnue %s (-help pour la liste).\n", argv[i] + 2);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-b") == 0) {
+            binaryOutput = 1;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            powerOfTwo = 1;
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            statsMode = 1;
+        } else if (strcmp(argv[i], "-testhash") == 0) {
+            hashReport = 1;
+        } else if (strncmp(argv[i], "-e", 2) == 0) {
+            const char* name = argv[i] + 2;
+            if (strcmp(name, "1") == 0 || strcmp(name, "chainage") == 0) {
+                engine = ENGINE_CHAINAGE;
+            } else if (strcmp(name, "2") == 0 || strcmp(name, "robinhood") == 0) {
+                engine = ENGINE_ROBINHOOD;
+            } else if (strcmp(name, "3") == 0 || strcmp(name, "parfait") == 0) {
+                engine = ENGINE_PARFAIT;
+            } else {
+                fprintf(stderr, "Erreur : moteur de table inconnu %s (chainage, robinhood ou parfait).\n", name);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-c", 2) == 0 && strcmp(argv[i], "-csv") != 0) {
+            maxLoad = atof(argv[i] + 2);
+            if (maxLoad <= 0) {
+                fprintf(stderr, "Erreur : taux de remplissage invalide.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-f", 2) == 0) {
+            bloomRate = atof(argv[i] + 2);
+            if (bloomRate <= 0 || bloomRate >= 1) {
+                fprintf(stderr, "Erreur : taux de faux positifs invalide (entre 0 et 1 exclus).\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-n", 2) == 0) {
+            normalization = findNormalization(argv[i] + 2);
+            if (normalization < 0) {
+                fprintf(stderr, "Erreur : normalisation inconnue %s (-help pour la liste).\n", argv[i] + 2);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-trie") == 0) {
+            trieMode = 1;
+        } else if (strncmp(argv[i], "-a", 2) == 0) {
+            completionPrefix = argv[i] + 2;
+        } else if (strncmp(argv[i], "-d", 2) == 0) {
+            maxDistance = atoi(argv[i] + 2);
+            if (maxDistance <= 0) {
+                fprintf(stderr, "Erreur : distance d'édition invalide.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-k", 2) == 0) {
+            nbCompletions = atoi(argv[i] + 2);
+            if (nbCompletions <= 0) {
+                fprintf(stderr, "Erreur : nombre de complétions invalide.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-r") == 0) {
+            searchMode = 1;
+        } else if (strncmp(argv[i], "-q", 2) == 0) {
+            queryFile = argv[i] + 2;
+        } else if (strcmp(argv[i], "-muet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "-csv") == 0) {
+            csvMode = 1;
+        } else if (strncmp(argv[i], "-j", 2) == 0 || strncmp(argv[i], "-l", 2) == 0 || strncmp(argv[i], "-m", 2) == 0) {
+            // Nombres de threads des recherches (-j), du chargement (-l) ou des
+            // lecteurs de la charge mixte (-m, 0 : chargement seul)
+            char option = argv[i][1];
+            int count = parseThreadList(argv[i][2] ? argv[i] + 2 : (option == 'm' ? "0,1,2,4" : "1,2,4,8"),
+                option == 'j' ? threadCounts : option == 'l' ? loadCounts : readerCounts, option == 'm' ? 0 : 1);
+            if (count < 0) {
+                fprintf(stderr, "Erreur : nombre de threads invalide (%d à %d) : %s\n", option == 'm' ? 0 : 1, MAX_THREADS, argv[i] + 2);
                 return EXIT_FAILURE;
             }
+            *(option == 'j' ? &nbThreadCounts : option == 'l' ? &nbLoadCounts : &nbReaderCounts) = count;
         } else {
             fprintf(stderr, "Erreur : argument inconnu %s\n", argv[i]);
             return EXIT_FAILURE;
         }
     }
 
-    //  Paramètres requis
-    if (nbSlots == 0 || hashFunctionChoice == 0) {
-        fprintf(stderr, "Erreur : les paramètres -s et -h sont obligatoires.\n");
+    //  Paramètres requis (-s n'est qu'une taille initiale ; un instantané fixe
+    //  lui-même sa fonction de hachage et sa taille)
+    int snapshot = inputFile && isSnapshot(inputFile);
+    if (hashFunctionChoice <= 0 && !hashReport && !snapshot) {
+        fprintf(stderr, "Erreur : le paramètre -h est obligatoire.\n");
         return EXIT_FAILURE;
     }
-
-    // Choix fonction de hachage
-    hashFunction hashFunc = NULL;
-    if (hashFunctionChoice == 1) {
-        hashFunc = hashFunction1;
-    } else if (hashFunctionChoice == 2) {
-        hashFunc = hashFunction2;
-    } else {
-        fprintf(stderr, "Erreur : numéro de fonction de hachage invalide (1 ou 2 uniquement).\n");
+    if (binaryOutput && !outputFile) {
+        fprintf(stderr, "Erreur : -b s'utilise avec -o<fichier sortie>.\n");
+        return EXIT_FAILURE;
+    }
+    if (csvMode && (!queryFile || nbThreadCounts > 0)) {
+        fprintf(stderr, "Erreur : -csv s'utilise avec -q<fichier requêtes>, sans -j.\n");
+        return EXIT_FAILURE;
+    }
+    if (nbThreadCounts > 0 && !queryFile) {
+        fprintf(stderr, "Erreur : -j s'utilise avec -q<fichier requêtes>.\n");
+        return EXIT_FAILURE;
+    }
+    if (nbReaderCounts > 0 && (!inputFile || snapshot || !queryFile || engine != ENGINE_CHAINAGE)) {
+        fprintf(stderr, "Erreur : -m s'utilise avec -i<fichier de données>, -q<fichier requêtes> et le moteur chainage.\n");
+        return EXIT_FAILURE;
+    }
+    if (nbCompletions > 0 && !completionPrefix && maxDistance == 0) {
+        fprintf(stderr, "Erreur : -k s'utilise avec -a<préfixe> ou -d<distance>.\n");
+        return EXIT_FAILURE;
+    }
+    if (bloomRate > 0 && nbReaderCounts > 0) {
+        fprintf(stderr, "Erreur : -f ne s'utilise pas avec -m (le filtre est construit après le chargement).\n");
+        return EXIT_FAILURE;
+    }
+    if (nbLoadCounts > 0 && (!inputFile || snapshot)) {
+        fprintf(stderr, "Erreur : -l s'utilise avec -i<fichier de données> (pas un instantané).\n");
+        return EXIT_FAILURE;
+    }
+    if (engine == ENGINE_ROBINHOOD && maxLoad >= 1) {
+        fprintf(stderr, "Erreur : le taux de remplissage de robinhood doit être inférieur à 1.\n");
         return EXIT_FAILURE;
     }
 
+    // Choix fonction de hachage (la comparaison -testhash utilise la première par défaut)
+    hashFunction hashFunc = hashFunctions[hashFunctionChoice > 0 ? hashFunctionChoice - 1 : 0].func;
+
+    // Arrondi à une puissance de 2 : l'alvéole s'obtient par un masque
+    if (powerOfTwo) {
+        int rounded = 1;
+        while (rounded < nbSlots) rounded *= 2;
+        nbSlots = rounded;
+    }
+
+    // Charge mixte : recherches pendant le chargement, une mesure par nombre de lecteurs
+    if (nbReaderCounts > 0) {
+        t_arena* queryArena = createArena();
+        int nbQueries;
+        char** queries = readQueries(queryFile, queryArena, &nbQueries);
+        mixedWorkloadReport(inputFile, nbSlots, hashFunc, maxLoad, normalization, queries, nbQueries, readerCounts, nbReaderCounts);
+        free(queries);
+        freeArena(queryArena);
+        return EXIT_SUCCESS;
+    }
+
+    // Passage à l'échelle du chargement : une construction par nombre de threads
+    if (nbLoadCounts > 1) {
+        loadScalingReport(inputFile, engine, nbSlots, hashFunc, maxLoad, normalization, loadCounts, nbLoadCounts);
+        return EXIT_SUCCESS;
+    }
+
+    // Construire la table de hachage (instantané, fichier projeté en mémoire, ou saisie manuelle)
     t_metadata metadata;
-    FILE* input = inputFile ? fopen(inputFile, "r") : stdin;
-    if (inputFile && !input) {
-        perror("Erreur d'ouverture du fichier d'entrée");
-        return EXIT_FAILURE;
+    t_hashtable* table;
+    double buildStart = now();
+    if (snapshot) {
+        int snapshotHash;
+        table = loadSnapshot(inputFile, &metadata, &snapshotHash);
+        if (hashFunctionChoice > 0 && hashFunctionChoice != snapshotHash) {
+            fprintf(stderr, "Attention : l'instantané utilise la fonction de hachage %s.\n", hashFunctions[snapshotHash - 1].name);
+        }
+        hashFunctionChoice = snapshotHash;
+        if (normalization >= 0 && normalization != table->normalization) {
+            fprintf(stderr, "Attention : l'instantané utilise la normalisation %s.\n", normalizationName(table->normalization));
+        }
+    } else {
+        // La table parfaite est construite à partir d'une table à chaînage complète
+        table = createHashTable(engine == ENGINE_PARFAIT ? ENGINE_CHAINAGE : engine, nbSlots, hashFunc);
+        if (maxLoad > 0) table->maxLoad = maxLoad;
+        if (normalization >= 0) table->normalization = normalization;
+        if (statsMode || quiet || csvMode) table->verbose = 0;
+        if (inputFile) {
+            parseFileHashMmap(inputFile, &metadata, table, nbLoadCounts > 0 ? loadCounts[0] : 1);
+        } else {
+            parseFileHash(stdin, &metadata, table);
+        }
+        if (engine == ENGINE_PARFAIT) buildPerfectHash(table);
+    }
+    if (bloomRate > 0) buildBloomFilter(table, bloomRate);
+    double buildTime = now() - buildStart;
+
+    // Comparaison des fonctions de hachage sur les clés chargées
+    if (hashReport) {
+        hashQualityReport(table);
+        freeHashTable(table, &metadata);
+        return EXIT_SUCCESS;
+    }
+
+    // Statistiques de répartition et d'occupation mémoire
+    if (statsMode) {
+        printStats(table, &metadata, inputFile ? inputFile : "-", hashFunctions[hashFunctionChoice - 1].name, buildTime);
     }
 
-    // Construire la table de hachage
-    t_hashtable* table = parseFileHash(input, &metadata, nbSlots, hashFunc);
-    if (inputFile) fclose(input);
+    // Index trié des clés : mémoire comparée à la table, complétions d'un préfixe
+    t_trie* trie = NULL;
+    double trieTime = 0;
+    if (trieMode || completionPrefix || maxDistance > 0) {
+        double trieStart = now();
+        trie = buildTrie(table);
+        trieTime = now() - trieStart;
+        if (trieMode) trieReport(trie, table, trieTime);
+        if (completionPrefix) printCompletions(trie, table, completionPrefix, nbCompletions);
+    }
+
+    // Recherche interactive : la table n'est écrite que si -o est donné
+    if (searchMode) {
+        printf("%d mots indexés dans %d alvéoles (%s), longueur moyenne de sondage : %.2f\n",
+            table->nbTuples, table->nbSlots, engineName(table->engine), averageProbeLength(table));
+        printf("Saisir les mots recherchés :\n\n");
+
+        char key[1000];
+        int nbSearches = 0;
+        long totalComparisons = 0, totalProbes = 0;
+        while (fgets(key, sizeof(key), stdin)) {
+            size_t len = strlen(key);
+            if (len > 0 && key[len - 1] == '\n') key[len - 1] = '\0';
+            if (strlen(key) == 0) break;
+            int comparisons, probes;
+            if (!searchKeyHash(table, &metadata, key, &comparisons, &probes) && maxDistance > 0) {
+                printSuggestions(trie, table, stdout, key, maxDistance, nbCompletions > 0 ? nbCompletions : DEFAULT_NB_SUGGESTIONS);
+            }
+            nbSearches++;
+            totalComparisons += comparisons;
+            totalProbes += probes;
+        }
+        if (nbSearches > 0) {
+            printf("%d recherches : %.2f comparaisons et %.2f sondages en moyenne\n",
+                nbSearches, (double)totalComparisons / nbSearches, (double)totalProbes / nbSearches);
+        }
+    }
+    // Recherche par lot des mots d'un fichier, avec mesure du débit
+    if (queryFile) {
+        t_arena* queryArena = createArena();
+        int nbQueries;
+        char** queries = readQueries(queryFile, queryArena, &nbQueries);
+        if (csvMode) {
+            csvReport(table, NULL, inputFile ? inputFile : "-", queryFile, queries, nbQueries, buildTime);
+        } else if (nbThreadCounts > 0) {
+            parallelScalingReport(table, &metadata, queries, nbQueries, quiet, threadCounts, nbThreadCounts);
+        } else {
+            runBatch(table, &metadata, queries, nbQueries, quiet);
+        }
+        if (trie && trieMode) {
+            if (csvMode) {
+                csvReport(table, trie, inputFile ? inputFile : "-", queryFile, queries, nbQueries, trieTime);
+            } else {
+                runTrieBatch(trie, table, &metadata, queries, nbQueries, quiet);
+            }
+        }
+        if (maxDistance > 0) {
+            suggestionReport(trie, table, queries, nbQueries, quiet, maxDistance, nbCompletions > 0 ? nbCompletions : DEFAULT_NB_SUGGESTIONS);
+        }
+        free(queries);
+        freeArena(queryArena);
+    }
+    if (trie) freeTrie(trie);
+    if ((searchMode || statsMode || queryFile || trie) && !outputFile) {
+        freeHashTable(table, &metadata);
+        return EXIT_SUCCESS;
+    }
 
     // Définition sortie
-    FILE* output = outputFile ? fopen(outputFile, "w") : stdout;
+    FILE* output = outputFile ? fopen(outputFile, binaryOutput ? "wb" : "w") : stdout;
     if (outputFile && !output) {
         perror("Erreur d'ouverture du fichier de sortie");
         freeHashTable(table, &metadata);
         return EXIT_FAILURE;
     }
 
-    // Sauvegarde ou affichage de la table
-    saveHashTableToFile(table, output, &metadata);
+    // Sauvegarde (texte ou instantané binaire) ou affichage de la table
+    if (binaryOutput) {
+        saveSnapshot(table, output, &metadata, hashFunctionChoice);
+    } else {
+        saveHashTableToFile(table, output, &metadata);
+    }
 
     // Fermer le fichier de sortie s'il est utilisé
     if (outputFile) fclose(output);
@@ -125,307 +888,2562 @@ int main(int argc, char* argv[]) {
 
 
 // Fonction de hachage 1
-unsigned int hashFunction1(const char* key, int nbSlots) {
+// Les fonctions renvoient le hachage complet : la table le réduit à son nombre
+// d'alvéoles, et Robin Hood le conserve comme empreinte.
+uint64_t hashFunction1(const char* key, size_t len) {
     unsigned int hash = 0;
-    while (*key) {
-        hash = (hash * 31) + *key++;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash * 31) + key[i];
     }
-    return hash % nbSlots;
+    return hash;
 }
 
 // Fonction de hachage 2
-unsigned int hashFunction2(const char* key, int nbSlots) {
+uint64_t hashFunction2(const char* key, size_t len) {
     unsigned int hash = 5381;
-    while (*key) {
-        hash = ((hash << 5) + hash) + *key++;
+    for (size_t i = 0; i < len; i++) {
+        hash = ((hash << 5) + hash) + key[i];
     }
-    return hash % nbSlots;
+    return hash;
 }
 
-
-// Lecture d'une ligne
-char* readLine(FILE* file) {
-    char buffer[1000];
-    if (fgets(buffer, sizeof(buffer), file) == NULL) {
-        return NULL;
+// FNV-1a 64 bits : xor de l'octet puis multiplication par le nombre premier FNV
+uint64_t hashFnv1a(const char* key, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 0x100000001b3ULL;
     }
-    size_t len = strlen(buffer);
-    if (buffer[len - 1] == '\n') buffer[len - 1] = '\0';
-    char* line = malloc(len + 1);
-    assert(line != NULL); 
-    strcpy(line, buffer);
-    return line;
+    return hash;
 }
 
-// Allocation dynamique d'un champ
-char* allocateField(const char* source) {
-    char* field = malloc(strlen(source) + 1);
-    assert(field != NULL); 
-    strcpy(field, source);
-    return field;
+// Mélangeur 64 bits dans l'esprit de wyhash/xxHash : la clé est lue par mots
+// de 8 octets, chaque mot est mélangé par multiplication, puis le résultat
+// passe par la finalisation de MurmurHash3 pour que tous les bits dépendent
+// de toute la clé (indispensable avec un masque)
+uint64_t hashMix64(const char* key, size_t len) {
+    const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = 0x243f6a8885a308d3ULL ^ len;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+    if (i < len) {
+        uint64_t word = 0;
+        memcpy(&word, key + i, len - i);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
+// Mode d'une normalisation désignée par son nom, -1 si inconnue
+int findNormalization(const char* name) {
+    for (int i = 0; i < NB_NORMALIZATIONS; i++) {
+        if (strcmp(normalizations[i].name, name) == 0) return normalizations[i].mode;
+    }
+    return -1;
+}
 
-// Analyse du fichier et remplissage de la table de hachage
-t_hashtable* parseFileHash(FILE* inputFile, t_metadata* metadata, int nbSlots, hashFunction hashFunc) {    
-    FILE* file = inputFile;
-    int isManualInput = (file == stdin);
+// Nom d'un mode de normalisation, NULL s'il n'existe pas (instantané invalide)
+const char* normalizationName(int mode) {
+    for (int i = 0; i < NB_NORMALIZATIONS; i++) {
+        if (normalizations[i].mode == mode) return normalizations[i].name;
+    }
+    return NULL;
+}
 
-    t_hashtable* table = malloc(sizeof(t_hashtable));
-    assert(table != NULL);
-    table->slots = calloc(nbSlots, sizeof(t_node*));
-    assert(table->slots != NULL);
-    table->nbSlots = nbSlots;
-    table->nbTuples = 0;
+// Caractère UTF-8 en tête de text (len octets disponibles) : renvoie son point
+// de code et sa taille dans *size, ou -1 pour une séquence invalide (un octet)
+long decodeUtf8(const unsigned char* text, size_t len, size_t* size) {
+    *size = 1;
+    unsigned char c = text[0];
+    if (c < 0x80) return c;
+    size_t n = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+    if (n == 0 || n > len || c > 0xF4) return -1;
+    long codePoint = c & (0x7F >> n);
+    for (size_t i = 1; i < n; i++) {
+        if ((text[i] & 0xC0) != 0x80) return -1;
+        codePoint = (codePoint << 6) | (text[i] & 0x3F);
+    }
+    // Formes trop longues, demi-codets et points au-delà de U+10FFFF refusés
+    static const long minimum[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (codePoint < minimum[n] || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) return -1;
+    *size = n;
+    return codePoint;
+}
 
-    metadata->sep = '\0';
-    metadata->nbFields = 0;
-    metadata->fieldNames = NULL;
+// Lettre précomposée d'une base ASCII et d'un diacritique, 0 s'il n'y en a pas
+unsigned int composeLatin(unsigned int base, unsigned int mark) {
+    int low = 0, high = NB_COMPOSITIONS - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        const t_composition* composition = &compositions[middle];
+        int order = (unsigned char)composition->base != base ? (int)(unsigned char)composition->base - (int)base
+                                                             : (int)composition->mark - (int)mark;
+        if (order == 0) return composition->composed;
+        if (order < 0) low = middle + 1;
+        else high = middle - 1;
+    }
+    return 0;
+}
 
-    char* line;
-    int step = 0;
+// Écriture d'un point de code en UTF-8 à out[position] ; renvoie la position
+// suivante. Sur place, un octet identique n'est pas réécrit : les pages du
+// fichier projeté ne sont copiées que si une clé change vraiment.
+size_t putCodePoint(char* out, size_t position, int inPlace, unsigned int codePoint) {
+    unsigned char bytes[4];
+    size_t n;
+    if (codePoint < 0x80) {
+        bytes[0] = codePoint;
+        n = 1;
+    } else if (codePoint < 0x800) {
+        bytes[0] = 0xC0 | (codePoint >> 6);
+        bytes[1] = 0x80 | (codePoint & 0x3F);
+        n = 2;
+    } else if (codePoint < 0x10000) {
+        bytes[0] = 0xE0 | (codePoint >> 12);
+        bytes[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[2] = 0x80 | (codePoint & 0x3F);
+        n = 3;
+    } else {
+        bytes[0] = 0xF0 | (codePoint >> 18);
+        bytes[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+        bytes[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[3] = 0x80 | (codePoint & 0x3F);
+        n = 4;
+    }
+    for (size_t i = 0; i < n; i++, position++) {
+        if (!inPlace || out[position] != (char)bytes[i]) out[position] = bytes[i];
+    }
+    return position;
+}
 
-    while (1) {
-        if (isManualInput) {
-            if (step == 0) {
-                printf("Entrez le séparateur à utiliser (un seul caractère) : ");
-            } else if (step == 1) {
-                printf("Entrez le nombre de champs dans chaque enregistrement : ");
-            } else if (step == 2) {
-                printf("Entrez les noms des champs, séparés par le séparateur : ");
-            } else {
-                printf("Entrez une nouvelle ligne de données (clé et champs séparés par le séparateur), ou une ligne vide pour terminer : ");
-            }
-        }
+// Normalisation d'une clé de *len octets selon mode : renvoie key elle-même si
+// rien ne change, sinon out (de *len octets au moins, éventuellement égal à key
+// pour une réécriture sur place), et met à jour *len.
+// Chemin rapide : une clé ASCII est testée 8 octets à la fois (aucun octet de
+// poids fort, et aucune majuscule si on plie la casse) et renvoyée telle quelle,
+// comme en NFC seule une clé sans diacritique combinant.
+const char* normalizeKey(int mode, const char* key, size_t* len, char* out) {
+    if (mode == NORMALISATION_AUCUNE) return key;
+    size_t n = *len;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, 8);
+        if (word & 0x8080808080808080ULL) break;
+        // Octet de 'A' à 'Z' : x + 0x3F atteint 0x80, x + 0x25 pas encore
+        uint64_t upper = ((word + 0x3F3F3F3F3F3F3F3FULL) ^ (word + 0x2525252525252525ULL)) & 0x8080808080808080ULL;
+        if ((mode & NORMALISATION_CASSE) && upper) break;
+    }
+    while (i < n && (unsigned char)key[i] < 0x80 && !((mode & NORMALISATION_CASSE) && key[i] >= 'A' && key[i] <= 'Z')) i++;
+    if (i == n) return key;
 
-        line = readLine(file);
-        if (!line) break;
+    // NFC seule : sans diacritique combinant, la clé est déjà sous forme NFC
+    if (mode == NORMALISATION_NFC && !memchr(key + i, 0xCC, n - i) && !memchr(key + i, 0xCD, n - i)) return key;
 
-        // Ignore les commentaires
-        if (line[0] == '#' && strlen(line) > 1) {
-            free(line);
+    // Chemin général à partir du caractère précédent (base ASCII d'un éventuel
+    // diacritique combinant)
+    if (i > 0) i--;
+    const unsigned char* text = (const unsigned char*)key;
+    int inPlace = out == key;
+    if (!inPlace) memcpy(out, key, i);
+    size_t position = i;
+    while (i < n) {
+        // Caractère ASCII qui n'est pas suivi d'un diacritique (U+0300 à U+036F
+        // commencent par 0xCC ou 0xCD) : recopié, en minuscule s'il le faut
+        if (text[i] < 0x80 && (i + 1 == n || (text[i + 1] != 0xCC && text[i + 1] != 0xCD))) {
+            char c = (mode & NORMALISATION_CASSE) && key[i] >= 'A' && key[i] <= 'Z' ? key[i] + ('a' - 'A') : key[i];
+            if (!inPlace || out[position] != c) out[position] = c;
+            position++;
+            i++;
             continue;
         }
-
-        if (step == 0) {
-            if (strlen(line) == 1) {
-                metadata->sep = line[0];
-                printf("Séparateur détecté : '%c'\n", metadata->sep);
-                free(line);
-                step++;
-                continue;
-            } else {
-                fprintf(stderr, "Erreur : séparateur invalide (doit être un caractère unique).\n");
-                free(line);
-                if (isManualInput) continue;
-                fclose(file);
-                exit(EXIT_FAILURE);
-            }
+        size_t size;
+        long codePoint = decodeUtf8(text + i, n - i, &size);
+        if (codePoint < 0) {
+            // Octet invalide gardé tel quel
+            if (!inPlace || position != i) out[position] = key[i];
+            position++;
+            i++;
+            continue;
         }
+        i += size;
 
-        if (step == 1) {
-            metadata->nbFields = atoi(line);
-            if (metadata->nbFields <= 0) {
-                fprintf(stderr, "Erreur : nombre de champs invalide : %s\n", line);
-                free(line);
-                if (isManualInput) continue;
-                fclose(file);
-                exit(EXIT_FAILURE);
-            }
-            metadata->fieldNames = malloc(metadata->nbFields * sizeof(char*));
-            assert(metadata->fieldNames != NULL);
-            for (int i = 0; i < metadata->nbFields; i++) {
-                metadata->fieldNames[i] = NULL;
+        // Recomposition NFC : base ASCII suivie d'un diacritique combinant
+        if (codePoint < 0x80 && i < n) {
+            size_t markSize;
+            long mark = decodeUtf8(text + i, n - i, &markSize);
+            unsigned int composed = mark >= 0x300 && mark <= 0x36F ? composeLatin(codePoint, mark) : 0;
+            if (composed) {
+                codePoint = composed;
+                i += markSize;
             }
-            printf("%d champs détectés.\n", metadata->nbFields);
-            free(line);
-            step++;
-            continue;
         }
 
-        if (step == 2) {
-            char* token = strtok(line, &metadata->sep);
-            for (int i = 0; i < metadata->nbFields; i++) {
-                if (token != NULL) {
-                    metadata->fieldNames[i] = allocateField(token);
-                    token = strtok(NULL, &metadata->sep);
-                } else {
-                    metadata->fieldNames[i] = allocateField("");
+        if (mode & NORMALISATION_ACCENTS) {
+            if (codePoint >= 0x300 && codePoint <= 0x36F) continue;
+            if (codePoint >= LATIN_FIRST && codePoint < LATIN_FIRST + LATIN_COUNT && latinBase[codePoint - LATIN_FIRST][0]) {
+                for (const char* letter = latinBase[codePoint - LATIN_FIRST]; *letter; letter++) {
+                    char c = (mode & NORMALISATION_CASSE) && *letter >= 'A' && *letter <= 'Z' ? *letter + ('a' - 'A') : *letter;
+                    position = putCodePoint(out, position, inPlace, (unsigned char)c);
                 }
+                continue;
             }
-            printf("Noms des champs : ");
-            for (int i = 0; i < metadata->nbFields; i++) {
-                printf("%s%s", metadata->fieldNames[i], (i == metadata->nbFields - 1) ? "\n" : ", ");
-            }
-            free(line);
-            step++;
-            continue;
         }
+        if (mode & NORMALISATION_CASSE) {
+            if (codePoint >= 'A' && codePoint <= 'Z') codePoint += 'a' - 'A';
+            else if (codePoint >= LATIN_FIRST && codePoint < LATIN_FIRST + LATIN_COUNT) codePoint = latinLower[codePoint - LATIN_FIRST];
+        }
+        position = putCodePoint(out, position, inPlace, codePoint);
+    }
+    *len = position;
+    return out;
+}
 
-        if (step >= 3) {
-            if (strlen(line) == 0) {
-                free(line);
-                break;
-            }
+// Normalisation sur place d'une clé du texte de la table (vue raccourcie au besoin)
+void normalizeField(t_hashtable* table, t_view* field) {
+    size_t len = field->len;
+    normalizeKey(table->normalization, table->text + field->offset, &len, table->text + field->offset);
+    field->len = len;
+}
 
-            t_tuple tuple;
-            char* token = strtok(line, &metadata->sep);
+// Numéro (à partir de 1) d'une fonction désignée par son numéro ou son nom, 0 si inconnue
+int findHashFunction(const char* name) {
+    int number = atoi(name);
+    if (number >= 1 && number <= NB_HASH_FUNCTIONS) return number;
+    for (int i = 0; i < NB_HASH_FUNCTIONS; i++) {
+        if (strcmp(hashFunctions[i].name, name) == 0) return i + 1;
+    }
+    return 0;
+}
 
-            if (token == NULL) {
-                fprintf(stderr, "Erreur : ligne mal formatée, clé manquante.\n");
-                free(line);
-                continue;
-            }
-            tuple.key = allocateField(token);
+// Début du texte d'un champ (non terminé par '\0' : utiliser field.len)
+const char* fieldText(const t_hashtable* table, t_view field) {
+    return table->text + field.offset;
+}
 
-            tuple.definitions = malloc(sizeof(char**));
-            assert(tuple.definitions != NULL);
-            tuple.definitions[0] = malloc((metadata->nbFields - 1) * sizeof(char*));
-            assert(tuple.definitions[0] != NULL);
-            for (int i = 0; i < metadata->nbFields - 1; i++) {
-                token = strtok(NULL, &metadata->sep);
-                tuple.definitions[0][i] = allocateField(token ? token : "");
-            }
-            tuple.nbDefinitions = 1;
+// Découpage de text[start, end[ en au plus nbFields vues, sans copie, en un
+// seul parcours (memchr saute d'un séparateur au suivant). Les champs vides
+// sont conservés et, contrairement à splitFields (fr_commun.h), le texte
+// projeté n'est pas modifié : aucune page n'est recopiée et le découpage peut
+// se faire depuis plusieurs threads. Les séparateurs au-delà du
+// dernier champ sont ignorés, les champs absents reçoivent une vue vide.
+// Renvoie le nombre de champs trouvés.
+int splitViews(const char* text, size_t start, size_t end, char sep, t_view* fields, int nbFields) {
+    int count = 0;
+    size_t pos = start;
+    while (count < nbFields) {
+        const char* next = memchr(text + pos, sep, end - pos);
+        size_t fieldEnd = next ? (size_t)(next - text) : end;
+        fields[count].offset = pos;
+        fields[count].len = fieldEnd - pos;
+        count++;
+        if (!next) break;
+        pos = fieldEnd + 1;
+    }
+    for (int i = count; i < nbFields; i++) {
+        fields[i].offset = end;
+        fields[i].len = 0;
+    }
+    return count;
+}
 
-            insertTupleHash(table, &tuple, nbSlots, metadata, hashFunc);
-            free(line);
+// Recopie d'une ligne lue sur un flux à la fin du texte de la table
+// Renvoie la position de la ligne dans le texte.
+size_t appendText(t_hashtable* table, const char* line, size_t len) {
+    if (table->concurrent && table->textSize + len > table->textCapacity) {
+        if (table->text) {
+            fprintf(stderr, "Erreur : données trop volumineuses (4 Go maximum).\n");
+            exit(EXIT_FAILURE);
         }
+        table->text = mmap(NULL, TEXT_RESERVATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (table->text == MAP_FAILED) {
+            perror("Erreur de réservation du texte");
+            exit(EXIT_FAILURE);
+        }
+        table->textCapacity = TEXT_RESERVATION;
     }
-
-    if (isManualInput) {
-        printf("Fin de l'entrée manuelle.\n");
+    if (table->textSize + len > table->textCapacity) {
+        size_t capacity = table->textCapacity ? table->textCapacity : 64 * 1024;
+        while (table->textSize + len > capacity) capacity *= 2;
+        if (capacity > UINT_MAX) {
+            fprintf(stderr, "Erreur : données trop volumineuses (4 Go maximum).\n");
+            exit(EXIT_FAILURE);
+        }
+        table->text = realloc(table->text, capacity);
+        assert(table->text != NULL);
+        table->textCapacity = capacity;
     }
+    size_t offset = table->textSize;
+    memcpy(table->text + offset, line, len);
+    table->textSize += len;
+    return offset;
+}
 
-    return table;
+// Repli d'un hachage 64 bits sur 32 bits (sans effet sur les fonctions 1 et 2)
+unsigned int foldHash(uint64_t hash) {
+    return (unsigned int)(hash ^ (hash >> 32));
 }
 
-// Insertion d'un tuple dans la table
-void insertTupleHash(t_hashtable* table, const t_tuple* tuple, int nbSlots, t_metadata* metadata, hashFunction hashFunc) {
-    unsigned int index = hashFunc(tuple->key, nbSlots);
-    t_node* current = table->slots[index];
+// Hachage d'une clé pour la table
+unsigned int hashKey(const t_hashtable* table, const char* key, size_t len) {
+    return foldHash(table->hashFunc(key, len));
+}
 
-    // Vérifier si la clé existe
-    while (current) {
-        if (strcmp(current->data.key, tuple->key) == 0) {
-            current->data.nbDefinitions++;
-            current->data.definitions = realloc(current->data.definitions, current->data.nbDefinitions * sizeof(char**));
-            assert(current->data.definitions != NULL);
-            current->data.definitions[current->data.nbDefinitions - 1] = malloc((metadata->nbFields - 1) * sizeof(char*));
-            assert(current->data.definitions[current->data.nbDefinitions - 1] != NULL);
-            for (int i = 0; i < metadata->nbFields - 1; i++) {
-                current->data.definitions[current->data.nbDefinitions - 1][i] = allocateField(tuple->definitions[0][i]);
-            }
-            return;
-        }
-        current = current->next;
+// Alvéole d'un hachage : masque si nbSlots est une puissance de 2, modulo sinon
+unsigned int slotIndex(unsigned int hash, int nbSlots) {
+    if ((nbSlots & (nbSlots - 1)) == 0) {
+        return hash & (nbSlots - 1);
     }
+    return hash % nbSlots;
+}
 
-    // Si la clé n'existe pas, créer un nouveau nœud
-    t_node* newNode = malloc(sizeof(t_node));
-    assert(newNode != NULL);
-    newNode->data.key = allocateField(tuple->key);
-    newNode->data.definitions = malloc(sizeof(char**));
-    assert(newNode->data.definitions != NULL);
-    newNode->data.definitions[0] = malloc((metadata->nbFields - 1) * sizeof(char*));
-    assert(newNode->data.definitions[0] != NULL);
-    for (int i = 0; i < metadata->nbFields - 1; i++) {
-        newNode->data.definitions[0][i] = allocateField(tuple->definitions[0][i]);
-    }
-    newNode->data.nbDefinitions = 1;
-    newNode->next = table->slots[index];
-    table->slots[index] = newNode;
-    table->nbTuples++;
+// Création d'une table vide
+t_hashtable* createHashTable(int engine, int nbSlots, hashFunction hashFunc) {
+    t_hashtable* table = malloc(sizeof(t_hashtable));
+    assert(table != NULL);
+    table->engine = engine;
+    table->hashFunc = hashFunc;
+    table->slots = NULL;
+    table->oldSlots = NULL;
+    table->oldNbSlots = 0;
+    table->rehashIndex = 0;
+    table->entries = NULL;
+    table->maxLoad = engine == ENGINE_CHAINAGE ? DEFAULT_LOAD_CHAINAGE : DEFAULT_LOAD_ROBINHOOD;
+    table->verbose = 1;
+    if (engine == ENGINE_CHAINAGE) {
+        table->slots = calloc(nbSlots, sizeof(t_node*));
+        assert(table->slots != NULL);
+    } else {
+        table->entries = calloc(nbSlots, sizeof(t_entry));
+        assert(table->entries != NULL);
+    }
+    table->nbSlots = nbSlots;
+    table->nbTuples = 0;
+    table->arena = createArena();
+    table->text = NULL;
+    table->textSize = 0;
+    table->textCapacity = 0;
+    table->concurrent = 0;
+    table->shared = NULL;
+    table->displacements = NULL;
+    table->nbBuckets = 0;
+    table->perfectSeed = 0;
+    table->normalization = NORMALISATION_NFC;
+    table->bloom = NULL;
+    table->bloomBits = 0;
+    table->bloomHashes = 0;
+    return table;
 }
 
-// Recherche d'une clé dans la table de hachage
-void searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int nbSlots, hashFunction hashFunc) {
-    unsigned int index = hashFunc(key, nbSlots);
-    t_node* current = table->slots[index];
-    int comparisons = 0;
-    int found = 0;
+// Tableau de nbSlots alvéoles vides, alloué dans l'arène : un ancien tableau
+// reste valide tant que la table existe, même remplacé par un plus grand
+t_slotArray* createSlotArray(t_arena* arena, int nbSlots) {
+    t_slotArray* array = arenaAlloc(arena, sizeof(t_slotArray) + nbSlots * sizeof(t_node*));
+    array->nbSlots = nbSlots;
+    memset(array->slots, 0, nbSlots * sizeof(t_node*));
+    return array;
+}
 
-    while (current) {
-        comparisons++;
-        if (strcmp(current->data.key, key) == 0) {
-            if (!found) {
-                printf("Recherche de %s : trouvé ! nb comparaisons : %d\n", key, comparisons);
-                found = 1;
-            }
-            printf("mot : %s\n", current->data.key);
-            for (int d = 0; d < current->data.nbDefinitions; d++) {
-                printf("Définition %d :\n", d + 1);
-                for (int j = 0; j < metadata->nbFields - 1; j++) {
-                    printf("  %s : %s\n", metadata->fieldNames[j + 1],
-                        strlen(current->data.definitions[d][j]) > 0 ? current->data.definitions[d][j] : "X");
-                }
-                printf("\n");
-            }
-        }
-        current = current->next;
-    }
-    if (!found) {
-        printf("Recherche de %s : échec ! nb comparaisons : %d\n", key, comparisons);
-    }
+// Passage d'une table vide (chaînage) en mode concurrent : des threads peuvent
+// chercher (lookupHash, searchKeyHash) pendant qu'un autre insère. Les lecteurs
+// ne prennent aucun verrou : un nœud publié n'est plus jamais modifié (une
+// nouvelle occurrence remplace le nœud par une copie) et les liens sont lus et
+// écrits de façon atomique. Les insertions se font une à une sous writeLock.
+void enableConcurrency(t_hashtable* table) {
+    assert(table->engine == ENGINE_CHAINAGE && table->nbTuples == 0);
+    table->shared = createSlotArray(table->arena, table->nbSlots);
+    free(table->slots);
+    table->slots = table->shared->slots;
+    pthread_mutex_init(&table->writeLock, NULL);
+    table->concurrent = 1;
 }
 
-// Libération de la mémoire
-void freeHashTable(t_hashtable* table, t_metadata* metadata) {
-    for (int i = 0; i < table->nbSlots; i++) {
-        t_node* current = table->slots[i];
+// Début d'un agrandissement (chaînage) : les anciennes alvéoles seront
+// migrées progressivement vers un tableau deux fois plus grand
+void startRehash(t_hashtable* table) {
+    table->oldSlots = table->slots;
+    table->oldNbSlots = table->nbSlots;
+    table->rehashIndex = 0;
+    table->nbSlots *= 2;
+    table->slots = calloc(table->nbSlots, sizeof(t_node*));
+    assert(table->slots != NULL);
+}
+
+// Migration des nbBuckets anciennes alvéoles suivantes
+void rehashStep(t_hashtable* table, int nbBuckets) {
+    while (table->oldSlots && nbBuckets-- > 0) {
+        t_node* current = table->oldSlots[table->rehashIndex];
         while (current) {
-            t_node* temp = current;
-            free(current->data.key);
-            for (int d = 0; d < current->data.nbDefinitions; d++) {
-                for (int j = 0; j < metadata->nbFields - 1; j++) {
-                    free(current->data.definitions[d][j]);
-                }
-                free(current->data.definitions[d]);
-            }
-            free(current->data.definitions);
-            current = current->next;
-            free(temp);
+            t_node* next = current->next;
+            unsigned int index = slotIndex(nodeHash(table, current), table->nbSlots);
+            current->next = table->slots[index];
+            table->slots[index] = current;
+            current = next;
+        }
+        table->oldSlots[table->rehashIndex] = NULL;
+        table->rehashIndex++;
+        if (table->rehashIndex == table->oldNbSlots) {
+            free(table->oldSlots);
+            table->oldSlots = NULL;
+            table->oldNbSlots = 0;
         }
     }
-    free(table->slots);
-    for (int i = 0; i < metadata->nbFields; i++) {
-        free(metadata->fieldNames[i]);
-    }
-    free(metadata->fieldNames);
-    free(table);
 }
 
-void saveHashTableToFile(t_hashtable* table, FILE* output, t_metadata* metadata) {
-    
-    fprintf(output, "%c\n", metadata->sep);
+// Fin de la migration en cours (après chargement : la table est alors stable)
+void completeRehash(t_hashtable* table) {
+    if (table->oldSlots) {
+        rehashStep(table, table->oldNbSlots - table->rehashIndex);
+    }
+}
 
-    fprintf(output, "%d\n", metadata->nbFields);
+// Traitement d'une ligne table->text[start, end[ selon l'étape de lecture :
+// séparateur, nombre de champs, noms des champs, puis données.
+// Renvoie 0 pour continuer, 1 en fin de données (ligne vide), -1 si erreur.
+int parseLineHash(t_hashtable* table, t_metadata* metadata, int* step, size_t start, size_t end) {
+    const char* line = table->text + start;
+    size_t len = end - start;
 
-    for (int i = 0; i < metadata->nbFields; i++) {
-        fprintf(output, "%s%c", metadata->fieldNames[i], (i == metadata->nbFields - 1) ? '\n' : metadata->sep);
+    // Ignore les commentaires
+    if (len > 1 && line[0] == '#') {
+        return 0;
     }
 
+    if (*step == 0) {
+        if (len != 1) {
+            fprintf(stderr, "Erreur : séparateur invalide (doit être un caractère unique).\n");
+            return -1;
+        }
+        metadata->sep = line[0];
+        if (table->verbose) printf("Séparateur détecté : '%c'\n", metadata->sep);
+        (*step)++;
+        return 0;
+    }
+
+    if (*step == 1) {
+        char* number = strndup(line, len);
+        assert(number != NULL);
+        metadata->nbFields = atoi(number);
+        if (metadata->nbFields <= 0) {
+            fprintf(stderr, "Erreur : nombre de champs invalide : %s\n", number);
+            free(number);
+            return -1;
+        }
+        free(number);
+        metadata->fieldNames = calloc(metadata->nbFields, sizeof(char*));
+        assert(metadata->fieldNames != NULL);
+        if (table->verbose) printf("%d champs détectés.\n", metadata->nbFields);
+        (*step)++;
+        return 0;
+    }
+
+    t_view fields[metadata->nbFields];
+    splitViews(table->text, start, end, metadata->sep, fields, metadata->nbFields);
+
+    if (*step == 2) {
+        for (int i = 0; i < metadata->nbFields; i++) {
+            metadata->fieldNames[i] = strndup(fieldText(table, fields[i]), fields[i].len);
+            assert(metadata->fieldNames[i] != NULL);
+        }
+        if (table->verbose) {
+            printf("Noms des champs : ");
+            for (int i = 0; i < metadata->nbFields; i++) {
+                printf("%s%s", metadata->fieldNames[i], (i == metadata->nbFields - 1) ? "\n" : ", ");
+            }
+        }
+        (*step)++;
+        return 0;
+    }
+
+    if (len == 0) {
+        return 1;
+    }
+    normalizeField(table, &fields[0]);
+    if (fields[0].len == 0) {
+        fprintf(stderr, "Erreur : ligne mal formatée, clé manquante.\n");
+        return 0;
+    }
+
+    // La clé est fields[0], la définition les champs suivants (rangés sous forme creuse)
+    t_tuple tuple;
+    uint64_t* definition = packDefinition(table->arena, fields + 1, metadata->nbFields);
+    tuple.key = fields[0];
+    tuple.definitions = &definition;
+    tuple.nbDefinitions = 1;
+    tuple.capacity = 1;
+    insertTupleHash(table, &tuple, metadata);
+    return 0;
+}
+
+// Lecture d'un flux ligne par ligne (saisie manuelle) et remplissage de la table
+void parseFileHash(FILE* inputFile, t_metadata* metadata, t_hashtable* table) {    
+    FILE* file = inputFile;
+    int isManualInput = (file == stdin);
+
+    metadata->sep = '\0';
+    metadata->nbFields = 0;
+    metadata->fieldNames = NULL;
+
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    int step = 0;
+
+    while (1) {
+        if (isManualInput) {
+            if (step == 0) {
+                printf("Entrez le séparateur à utiliser (un seul caractère) : ");
+            } else if (step == 1) {
+                printf("Entrez le nombre de champs dans chaque enregistrement : ");
+            } else if (step == 2) {
+                printf("Entrez les noms des champs, séparés par le séparateur : ");
+            } else {
+                printf("Entrez une nouvelle ligne de données (clé et champs séparés par le séparateur), ou une ligne vide pour terminer : ");
+            }
+        }
+
+        len = readLine(file, &line, &capacity);
+        if (len < 0) break;
+
+        size_t start = appendText(table, line, len);
+
+        int status = parseLineHash(table, metadata, &step, start, start + len);
+        if (status > 0) break;
+        if (status < 0) {
+            if (isManualInput) continue;
+            fclose(file);
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(line);
+
+    if (isManualInput) {
+        printf("Fin de l'entrée manuelle.\n");
+    }
+
+    completeRehash(table);
+}
+
+// Chargement d'un fichier projeté en mémoire : les clés et les champs sont des
+// vues sur les pages du fichier, sans aucune copie des lignes. Avec nbThreads > 1,
+// les données qui suivent l'en-tête sont analysées en parallèle.
+void parseFileHashMmap(const char* filename, t_metadata* metadata, t_hashtable* table, int nbThreads) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Erreur d'ouverture du fichier d'entrée");
+        exit(EXIT_FAILURE);
+    }
+
+    // Fichier vide, tube ou fichier trop gros : lecture ligne par ligne
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || (unsigned long long)st.st_size > UINT_MAX) {
+        close(fd);
+        FILE* file = fopen(filename, "r");
+        if (!file) {
+            perror("Erreur d'ouverture du fichier d'entrée");
+            exit(EXIT_FAILURE);
+        }
+        parseFileHash(file, metadata, table);
+        fclose(file);
+        return;
+    }
+
+    // Projection privée en écriture : les clés sont normalisées sur place, le
+    // fichier n'est jamais modifié (seules les pages réécrites sont copiées)
+    size_t size = st.st_size;
+    char* text = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED) {
+        perror("Erreur de projection du fichier d'entrée");
+        exit(EXIT_FAILURE);
+    }
+
+    table->text = text;
+    table->textSize = size;
+
+    metadata->sep = '\0';
+    metadata->nbFields = 0;
+    metadata->fieldNames = NULL;
+
+    int step = 0;
+    size_t start = 0;
+    while (start < size) {
+        if (step == 3 && nbThreads > 1) {
+            parseBodyParallel(table, metadata, start, nbThreads);
+            break;
+        }
+        const char* newline = memchr(text + start, '\n', size - start);
+        size_t end = newline ? (size_t)(newline - text) : size;
+        int status = parseLineHash(table, metadata, &step, start, end);
+        if (status > 0) break;
+        if (status < 0) exit(EXIT_FAILURE);
+        start = end + 1;
+    }
+
+    completeRehash(table);
+}
+
+// Thread de chargement : analyse des lignes de sa tranche, comme parseLineHash
+// pour les données, sans toucher à la table (les tuples sont gardés dans l'ordre)
+void* loadChunkWorker(void* arg) {
+    t_loadChunk* chunk = arg;
+    t_hashtable* table = chunk->table;
+    int nbFields = chunk->metadata->nbFields;
+    t_view fields[nbFields];
+
+    size_t start = chunk->begin;
+    while (start < chunk->end) {
+        const char* newline = memchr(table->text + start, '\n', chunk->end - start);
+        size_t end = newline ? (size_t)(newline - table->text) : chunk->end;
+        size_t len = end - start;
+        if (len == 0) {
+            chunk->stopped = 1;
+            break;
+        }
+        if (!(len > 1 && table->text[start] == '#')) {
+            splitViews(table->text, start, end, chunk->metadata->sep, fields, nbFields);
+            normalizeField(table, &fields[0]);
+            if (fields[0].len == 0) {
+                fprintf(stderr, "Erreur : ligne mal formatée, clé manquante.\n");
+            } else {
+                if (chunk->nbLines == chunk->capacity) {
+                    chunk->capacity = chunk->capacity ? 2 * chunk->capacity : 1024;
+                    chunk->lines = realloc(chunk->lines, chunk->capacity * sizeof(t_parsedLine));
+                    assert(chunk->lines != NULL);
+                }
+                t_parsedLine* line = &chunk->lines[chunk->nbLines++];
+                line->key = fields[0];
+                line->hash = hashKey(table, fieldText(table, fields[0]), fields[0].len);
+                line->definition = packDefinition(chunk->arena, fields + 1, nbFields);
+            }
+        }
+        start = end + 1;
+    }
+    return NULL;
+}
+
+// Analyse parallèle des données table->text[start, textSize[ : nbThreads tranches
+// coupées sur des fins de ligne, puis insertion dans l'ordre du fichier. La table
+// obtenue est identique à celle du chargement séquentiel (mêmes alvéoles, même
+// ordre des définitions) ; seule l'insertion reste sur le thread principal.
+void parseBodyParallel(t_hashtable* table, t_metadata* metadata, size_t start, int nbThreads) {
+    t_loadChunk chunks[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    size_t size = table->textSize;
+
+    size_t begin = start;
+    for (int t = 0; t < nbThreads; t++) {
+        size_t end = start + (size - start) * (t + 1) / nbThreads;
+        if (end < begin) end = begin;
+        if (end < size) {
+            const char* newline = memchr(table->text + end, '\n', size - end);
+            end = newline ? (size_t)(newline - table->text) + 1 : size;
+        }
+        t_loadChunk chunk = { table, metadata, begin, end, createArena(), NULL, 0, 0, 0 };
+        chunks[t] = chunk;
+        if (pthread_create(&threads[t], NULL, loadChunkWorker, &chunks[t]) != 0) {
+            fprintf(stderr, "Erreur : création du thread %d impossible.\n", t + 1);
+            exit(EXIT_FAILURE);
+        }
+        begin = end;
+    }
+    for (int t = 0; t < nbThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // Insertion dans l'ordre des tranches, jusqu'à la première ligne vide
+    int stopped = 0;
+    for (int t = 0; t < nbThreads; t++) {
+        for (int i = 0; !stopped && i < chunks[t].nbLines; i++) {
+            uint64_t* definition = chunks[t].lines[i].definition;
+            t_tuple tuple = { chunks[t].lines[i].key, &definition, 1, 1 };
+            insertTupleHashed(table, &tuple, chunks[t].lines[i].hash);
+        }
+        if (chunks[t].stopped) stopped = 1;
+        mergeArena(table->arena, chunks[t].arena);
+        free(chunks[t].lines);
+    }
+}
+
+// Passage à l'échelle du chargement : construction complète de la table (en-tête,
+// analyse, insertion, fin du rehachage) pour chaque nombre de threads demandé
+void loadScalingReport(const char* filename, int engine, int nbSlots, hashFunction hashFunc, double maxLoad, int normalization, const int* threadCounts, int nbCounts) {
+    double times[MAX_THREADS];
+    int nbTuples = 0;
+    for (int i = 0; i < nbCounts; i++) {
+        t_metadata metadata;
+        t_hashtable* table = createHashTable(engine == ENGINE_PARFAIT ? ENGINE_CHAINAGE : engine, nbSlots, hashFunc);
+        if (maxLoad > 0) table->maxLoad = maxLoad;
+        if (normalization >= 0) table->normalization = normalization;
+        table->verbose = 0;
+        double start = now();
+        parseFileHashMmap(filename, &metadata, table, threadCounts[i]);
+        if (engine == ENGINE_PARFAIT) buildPerfectHash(table);
+        times[i] = now() - start;
+        nbTuples = table->nbTuples;
+        freeHashTable(table, &metadata);
+    }
+    printf("%d mots indexés\n", nbTuples);
+    printf("%8s %12s %16s %10s\n", "threads", "temps (ms)", "mots/s", "gain");
+    for (int i = 0; i < nbCounts; i++) {
+        printf("%8d %12.3f %16.0f %10.2f\n", threadCounts[i], times[i] * 1000,
+            times[i] > 0 ? nbTuples / times[i] : 0, times[i] > 0 ? times[0] / times[i] : 0);
+    }
+}
+
+// Comparaison d'une clé de la table avec une chaîne
+int keyEquals(const t_hashtable* table, t_view key, const char* other, size_t len) {
+    return key.len == len && memcmp(fieldText(table, key), other, len) == 0;
+}
+
+// Comparaison d'une clé rangée (copie inlineKey si elle est courte, texte sinon)
+int storedKeyEquals(const t_hashtable* table, const char* inlineKey, t_view key, const char* other, size_t len) {
+    if (key.len != len) return 0;
+    if (len <= INLINE_KEY_SIZE) return memcmp(inlineKey, other, len) == 0;
+    return memcmp(fieldText(table, key), other, len) == 0;
+}
+
+// Copie d'une clé courte dans inlineKey (rien pour une clé longue)
+void copyInlineKey(const t_hashtable* table, char* inlineKey, t_view key) {
+    if (key.len <= INLINE_KEY_SIZE) memcpy(inlineKey, fieldText(table, key), key.len);
+}
+
+// Empreinte et clé courte d'un nœud dont data.key est rempli
+void setNodeKey(const t_hashtable* table, t_node* node, unsigned int hash) {
+#if INLINE_KEY_SIZE > 0
+    node->hash = hash;
+    copyInlineKey(table, node->inlineKey, node->data.key);
+#else
+    (void)table;
+    (void)node;
+    (void)hash;
+#endif
+}
+
+// Hachage de la clé d'un nœud (rangé dans le nœud, recalculé sinon)
+unsigned int nodeHash(const t_hashtable* table, const t_node* node) {
+#if INLINE_KEY_SIZE > 0
+    (void)table;
+    return node->hash;
+#else
+    return hashKey(table, fieldText(table, node->data.key), node->data.key.len);
+#endif
+}
+
+// Le nœud porte-t-il la clé ? L'empreinte écarte la plupart des autres clés
+// sans comparaison ; comparisons compte les comparaisons de clés effectuées.
+int nodeMatches(const t_hashtable* table, const t_node* node, const char* key, size_t len, unsigned int hash, int* comparisons) {
+#if INLINE_KEY_SIZE > 0
+    if (node->hash != hash) return 0;
+    (*comparisons)++;
+    return storedKeyEquals(table, node->inlineKey, node->data.key, key, len);
+#else
+    (void)hash;
+    (*comparisons)++;
+    return keyEquals(table, node->data.key, key, len);
+#endif
+}
+
+// Clé courte d'une case dont data.key est rempli
+void setEntryKey(const t_hashtable* table, t_entry* entry) {
+#if INLINE_KEY_SIZE > 0
+    copyInlineKey(table, entry->inlineKey, entry->data.key);
+#else
+    (void)table;
+    (void)entry;
+#endif
+}
+
+// Comparaison de la clé d'une case (après celle des empreintes)
+int entryKeyEquals(const t_hashtable* table, const t_entry* entry, const char* key, size_t len) {
+#if INLINE_KEY_SIZE > 0
+    return storedKeyEquals(table, entry->inlineKey, entry->data.key, key, len);
+#else
+    return keyEquals(table, entry->data.key, key, len);
+#endif
+}
+
+// Nombre de mots de 64 bits du bitmap d'une définition (nbFields - 1 champs)
+int fieldWords(int nbFields) {
+    return (nbFields - 1 + 63) / 64;
+}
+
+// Nombre de champs non vides d'une définition
+int definitionCount(const uint64_t* definition, int nbFields) {
+    int count = 0;
+    for (int w = 0; w < fieldWords(nbFields); w++) {
+        count += __builtin_popcountll(definition[w]);
+    }
+    return count;
+}
+
+// Champ field (0 pour le champ 1) d'une définition creuse : sa vue est rangée
+// après celles des champs non vides qui le précèdent ; vue vide s'il est absent
+t_view definitionField(const uint64_t* definition, int nbFields, int field) {
+    uint64_t bit = (uint64_t)1 << (field % 64);
+    const uint64_t* word = definition + field / 64;
+    if (!(*word & bit)) {
+        t_view empty = { 0, 0 };
+        return empty;
+    }
+    int index = __builtin_popcountll(*word & (bit - 1));
+    for (const uint64_t* w = definition; w < word; w++) {
+        index += __builtin_popcountll(*w);
+    }
+    return ((const t_view*)(definition + fieldWords(nbFields)))[index];
+}
+
+// Copie des nbFields - 1 champs d'une définition dans l'arène, sous forme creuse
+uint64_t* packDefinition(t_arena* arena, const t_view* fields, int nbFields) {
+    int words = fieldWords(nbFields);
+    int count = 0;
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j].len > 0) count++;
+    }
+    uint64_t* definition = arenaAlloc(arena, words * sizeof(uint64_t) + count * sizeof(t_view));
+    memset(definition, 0, words * sizeof(uint64_t));
+    t_view* values = (t_view*)(definition + words);
+    for (int j = 0; j < nbFields - 1; j++) {
+        if (fields[j].len > 0) {
+            definition[j / 64] |= (uint64_t)1 << (j % 64);
+            *values++ = fields[j];
+        }
+    }
+    return definition;
+}
+
+// Recherche sans affichage : renvoie le tuple de la clé, NULL si absente.
+// comparisons compte les comparaisons de clés, probes les nœuds ou cases visités
+// (aucun si le filtre de Bloom écarte la clé).
+t_tuple* lookupHash(t_hashtable* table, const char* key, size_t len, unsigned int hash, int* comparisons, int* probes) {
+    if (table->bloom && !bloomMayContain(table, key, len)) {
+        *comparisons = 0;
+        *probes = 0;
+        return NULL;
+    }
+    return probeTable(table, key, len, hash, comparisons, probes);
+}
+
+// Sondage de la table seule, sans consulter le filtre de Bloom
+t_tuple* probeTable(t_hashtable* table, const char* key, size_t len, unsigned int hash, int* comparisons, int* probes) {
+    *comparisons = 0;
+    *probes = 0;
+
+    // Table parfaite : la seule case possible, au plus une comparaison (aucune
+    // si la case est vide)
+    if (table->engine == ENGINE_PARFAIT) {
+        uint64_t perfect = perfectKeyHash(key, len, table->perfectSeed);
+        uint32_t displacement = table->displacements[perfectBucket(perfect, table->nbBuckets)];
+        t_entry* entry = &table->entries[perfectPosition(perfect, displacement, table->nbSlots)];
+        *probes = 1;
+        if (entry->dist == 0) return NULL;
+        *comparisons = 1;
+        return entryKeyEquals(table, entry, key, len) ? &entry->data : NULL;
+    }
+
+    if (table->concurrent) {
+        const t_slotArray* array = __atomic_load_n(&table->shared, __ATOMIC_ACQUIRE);
+        t_node* current = __atomic_load_n(&array->slots[slotIndex(hash, array->nbSlots)], __ATOMIC_ACQUIRE);
+        for (; current; current = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE)) {
+            (*probes)++;
+            if (nodeMatches(table, current, key, len, hash, comparisons)) {
+                return &current->data;
+            }
+        }
+        return NULL;
+    }
+
+    if (table->engine == ENGINE_CHAINAGE) {
+        for (t_node* current = table->slots[slotIndex(hash, table->nbSlots)]; current; current = current->next) {
+            (*probes)++;
+            if (nodeMatches(table, current, key, len, hash, comparisons)) {
+                return &current->data;
+            }
+        }
+        // Pendant une migration, la clé peut encore être dans une ancienne alvéole
+        unsigned int oldIndex = table->oldSlots ? slotIndex(hash, table->oldNbSlots) : 0;
+        if (table->oldSlots && oldIndex >= (unsigned int)table->rehashIndex) {
+            for (t_node* current = table->oldSlots[oldIndex]; current; current = current->next) {
+                (*probes)++;
+                if (nodeMatches(table, current, key, len, hash, comparisons)) {
+                    return &current->data;
+                }
+            }
+        }
+        return NULL;
+    }
+
+    // Robin Hood : les cases sont triées par distance à leur origine, on peut
+    // s'arrêter dès qu'une case est plus proche de son origine que la clé cherchée
+    unsigned int index = slotIndex(hash, table->nbSlots);
+    for (unsigned int dist = 1; ; dist++) {
+        t_entry* entry = &table->entries[index];
+        (*probes)++;
+        if (entry->dist < dist) {
+            return NULL;
+        }
+        if (entry->hash == hash) {
+            (*comparisons)++;
+            if (entryKeyEquals(table, entry, key, len)) {
+                return &entry->data;
+            }
+        }
+        if (++index == (unsigned int)table->nbSlots) index = 0;
+    }
+}
+
+// Placement d'une case (clé absente de la table) : une case déjà placée plus
+// près de son origine cède sa place et est replacée plus loin
+void insertRobinHood(t_hashtable* table, t_entry entry) {
+    unsigned int index = slotIndex(entry.hash, table->nbSlots);
+    entry.dist = 1;
+    while (table->entries[index].dist != 0) {
+        if (table->entries[index].dist < entry.dist) {
+            t_entry displaced = table->entries[index];
+            table->entries[index] = entry;
+            entry = displaced;
+        }
+        if (++index == (unsigned int)table->nbSlots) index = 0;
+        entry.dist++;
+    }
+    table->entries[index] = entry;
+}
+
+// Doublement du nombre de cases : les empreintes évitent de rehacher les clés
+void growRobinHood(t_hashtable* table) {
+    t_entry* oldEntries = table->entries;
+    int oldNbSlots = table->nbSlots;
+    table->nbSlots *= 2;
+    table->entries = calloc(table->nbSlots, sizeof(t_entry));
+    assert(table->entries != NULL);
+    for (int i = 0; i < oldNbSlots; i++) {
+        if (oldEntries[i].dist != 0) {
+            insertRobinHood(table, oldEntries[i]);
+        }
+    }
+    free(oldEntries);
+}
+
+// Insertion d'un tuple dans la table
+// Les vues du tuple désignent le texte de la table et sa définition (creuse)
+// est déjà dans l'arène : la table les garde telles quelles.
+void insertTupleHash(t_hashtable* table, const t_tuple* tuple, t_metadata* metadata) {
+    (void)metadata;
+    insertTupleHashed(table, tuple, hashKey(table, fieldText(table, tuple->key), tuple->key.len));
+}
+
+// Insertion d'un tuple dont le hachage est déjà calculé (chargement parallèle)
+void insertTupleHashed(t_hashtable* table, const t_tuple* tuple, unsigned int hash) {
+    if (table->concurrent) {
+        insertConcurrent(table, tuple, hash);
+        return;
+    }
+    const char* key = fieldText(table, tuple->key);
+    uint64_t* definition = tuple->definitions[0];
+
+    // Vérifier si la clé existe
+    int comparisons, probes;
+    t_tuple* existing = lookupHash(table, key, tuple->key.len, hash, &comparisons, &probes);
+    if (existing) {
+        // Ajouter une nouvelle occurrence pour cette clé
+        appendDefinition(table->arena, existing, definition);
+        return;
+    }
+
+    // Si la clé n'existe pas, créer un nouveau tuple
+    t_tuple data;
+    data.key = tuple->key;
+    data.definitions = arenaAlloc(table->arena, sizeof(uint64_t*));
+    data.definitions[0] = definition;
+    data.nbDefinitions = 1;
+    data.capacity = 1;
+
+    if (table->engine == ENGINE_CHAINAGE) {
+        if (table->oldSlots) {
+            rehashStep(table, REHASH_STEP);
+        } else if (table->nbTuples + 1 > table->maxLoad * table->nbSlots) {
+            startRehash(table);
+        }
+        unsigned int index = slotIndex(hash, table->nbSlots);
+        t_node* newNode = arenaAlloc(table->arena, sizeof(t_node));
+        newNode->data = data;
+        setNodeKey(table, newNode, hash);
+        newNode->next = table->slots[index];
+        table->slots[index] = newNode;
+    } else {
+        if (table->nbTuples + 1 > table->maxLoad * table->nbSlots) {
+            growRobinHood(table);
+        }
+        t_entry entry;
+        entry.hash = hash;
+        entry.data = data;
+        setEntryKey(table, &entry);
+        insertRobinHood(table, entry);
+    }
+    table->nbTuples++;
+}
+
+// Nouvelle occurrence d'une clé. Le tableau des définitions double quand il est
+// plein : une clé répétée n fois coûte O(n) copies au lieu de O(n²). Les
+// anciens tableaux restent dans l'arène (au plus autant que le dernier).
+void appendDefinition(t_arena* arena, t_tuple* tuple, uint64_t* definition) {
+    if (tuple->nbDefinitions == tuple->capacity) {
+        tuple->capacity *= 2;
+        uint64_t** definitions = arenaAlloc(arena, tuple->capacity * sizeof(uint64_t*));
+        memcpy(definitions, tuple->definitions, tuple->nbDefinitions * sizeof(uint64_t*));
+        tuple->definitions = definitions;
+    }
+    tuple->definitions[tuple->nbDefinitions++] = definition;
+}
+
+// Insertion dans une table concurrente. Les champs d'un nœud sont écrits avant
+// sa publication (écriture atomique du lien qui y mène) : un lecteur qui
+// l'atteint le voit complet. Une nouvelle occurrence d'une clé crée une copie du
+// nœud, substituée à l'original ; un lecteur arrêté sur l'original continue
+// sans rien voir changer (la copie peut partager son tableau de définitions :
+// l'original n'en lit que ses nbDefinitions premières cases).
+void insertConcurrent(t_hashtable* table, const t_tuple* tuple, unsigned int hash) {
+    pthread_mutex_lock(&table->writeLock);
+    t_node** head = &table->shared->slots[slotIndex(hash, table->shared->nbSlots)];
+    t_node** link = head;
+    t_node* current = *head;
+    int comparisons = 0;
+    while (current && !nodeMatches(table, current, fieldText(table, tuple->key), tuple->key.len, hash, &comparisons)) {
+        link = &current->next;
+        current = current->next;
+    }
+
+    t_node* newNode = arenaAlloc(table->arena, sizeof(t_node));
+    if (current) {
+        *newNode = *current;
+        appendDefinition(table->arena, &newNode->data, tuple->definitions[0]);
+        newNode->next = current->next;
+        __atomic_store_n(link, newNode, __ATOMIC_RELEASE);
+    } else {
+        newNode->data.key = tuple->key;
+        newNode->data.definitions = arenaAlloc(table->arena, sizeof(uint64_t*));
+        newNode->data.definitions[0] = tuple->definitions[0];
+        newNode->data.nbDefinitions = 1;
+        newNode->data.capacity = 1;
+        setNodeKey(table, newNode, hash);
+        newNode->next = *head;
+        __atomic_store_n(head, newNode, __ATOMIC_RELEASE);
+        table->nbTuples++;
+        if (table->nbTuples > table->maxLoad * table->nbSlots) {
+            growConcurrent(table);
+        }
+    }
+    pthread_mutex_unlock(&table->writeLock);
+}
+
+// Agrandissement d'une table concurrente : les nœuds sont recopiés dans un
+// tableau deux fois plus grand, publié d'un bloc. L'ancien tableau et ses nœuds
+// restent intacts dans l'arène pour les lecteurs qui les parcourent encore.
+void growConcurrent(t_hashtable* table) {
+    t_slotArray* oldArray = table->shared;
+    t_slotArray* array = createSlotArray(table->arena, oldArray->nbSlots * 2);
+    for (int i = 0; i < oldArray->nbSlots; i++) {
+        for (t_node* current = oldArray->slots[i]; current; current = current->next) {
+            unsigned int index = slotIndex(nodeHash(table, current), array->nbSlots);
+            t_node* copy = arenaAlloc(table->arena, sizeof(t_node));
+            *copy = *current;
+            copy->next = array->slots[index];
+            array->slots[index] = copy;
+        }
+    }
+    __atomic_store_n(&table->shared, array, __ATOMIC_RELEASE);
+    table->slots = array->slots;
+    table->nbSlots = array->nbSlots;
+}
+
+// Hachage de construction de la table parfaite : mix64 mélangé à une graine
+// (changée si la construction échoue). Indépendant de la fonction -h : deux clés
+// n'ont en pratique jamais le même hachage de 64 bits.
+uint64_t perfectKeyHash(const char* key, size_t len, uint32_t seed) {
+    uint64_t hash = hashMix64(key, len) ^ (seed * 0x9e3779b97f4a7c15ULL);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Seau d'une clé (bits remélangés, indépendants de ceux de perfectPosition)
+uint32_t perfectBucket(uint64_t hash, uint32_t nbBuckets) {
+    return (uint32_t)(((hash ^ (hash >> 29)) * 0xbf58476d1ce4e5b9ULL) >> 32) % nbBuckets;
+}
+
+// Case d'une clé pour un déplacement d = d1 * nbSlots + d0 de son seau :
+// (f1 + d0 * f2 + d1) mod nbSlots, f1 et f2 tirés des deux moitiés du hachage.
+// d0 varie le plus vite : les essais successifs sautent de f2 cases (f2 non
+// nul) au lieu de parcourir les cases voisines, déjà prises en fin de construction.
+uint32_t perfectPosition(uint64_t hash, uint32_t displacement, uint32_t nbSlots) {
+    uint32_t f1 = (uint32_t)hash % nbSlots;
+    uint32_t f2 = nbSlots > 1 ? (uint32_t)(hash >> 32) % (nbSlots - 1) + 1 : 0;
+    uint32_t d0 = displacement % nbSlots;
+    uint32_t d1 = displacement / nbSlots;
+    return (uint32_t)((f1 + (uint64_t)d0 * f2 + d1) % nbSlots);
+}
+
+// Placement des n clés dans n cases avec la graine seed : les seaux, du plus
+// grand au plus petit, prennent le premier déplacement qui envoie toutes leurs
+// clés dans des cases libres. Renvoie 0 si un seau ne peut être placé (deux
+// clés de même hachage, par exemple) : il faut changer de graine.
+int placePerfectKeys(t_hashtable* table, const t_tuple* tuples, uint32_t n, uint32_t seed, uint32_t* displacements, uint32_t* positions) {
+    uint32_t nbBuckets = table->nbBuckets;
+    uint64_t* hashes = malloc(n * sizeof(uint64_t));
+    uint32_t* first = calloc(nbBuckets + 1, sizeof(uint32_t));
+    uint32_t* members = malloc(n * sizeof(uint32_t));
+    uint32_t* order = malloc(nbBuckets * sizeof(uint32_t));
+    unsigned char* taken = calloc(n, 1);
+    assert(hashes != NULL && first != NULL && members != NULL && order != NULL && taken != NULL);
+
+    // Clés regroupées par seau (tri par comptage)
+    for (uint32_t i = 0; i < n; i++) {
+        hashes[i] = perfectKeyHash(fieldText(table, tuples[i].key), tuples[i].key.len, seed);
+        first[perfectBucket(hashes[i], nbBuckets) + 1]++;
+    }
+    uint32_t maxSize = 0;
+    for (uint32_t b = 0; b < nbBuckets; b++) {
+        if (first[b + 1] > maxSize) maxSize = first[b + 1];
+        first[b + 1] += first[b];
+    }
+    uint32_t* fill = malloc(nbBuckets * sizeof(uint32_t));
+    assert(fill != NULL);
+    memcpy(fill, first, nbBuckets * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        members[fill[perfectBucket(hashes[i], nbBuckets)]++] = i;
+    }
+
+    // Seaux par taille décroissante (tri par comptage sur la taille)
+    uint32_t* bySize = calloc(maxSize + 2, sizeof(uint32_t));
+    assert(bySize != NULL);
+    for (uint32_t b = 0; b < nbBuckets; b++) {
+        bySize[maxSize - (first[b + 1] - first[b]) + 1]++;
+    }
+    for (uint32_t size = 0; size <= maxSize; size++) {
+        bySize[size + 1] += bySize[size];
+    }
+    for (uint32_t b = 0; b < nbBuckets; b++) {
+        order[bySize[maxSize - (first[b + 1] - first[b])]++] = b;
+    }
+    free(bySize);
+    free(fill);
+
+    // Tous les couples (d0, d1) sont essayés avant d'abandonner
+    uint64_t maxDisplacement = (uint64_t)n * n < UINT32_MAX ? (uint64_t)n * n : UINT32_MAX;
+    uint32_t slots[maxSize + 1];
+    int placed = 1;
+    for (uint32_t o = 0; placed && o < nbBuckets; o++) {
+        uint32_t b = order[o];
+        uint32_t size = first[b + 1] - first[b];
+        uint64_t d;
+        for (d = 0; d < maxDisplacement; d++) {
+            uint32_t k;
+            for (k = 0; k < size; k++) {
+                slots[k] = perfectPosition(hashes[members[first[b] + k]], (uint32_t)d, n);
+                if (taken[slots[k]]) break;
+                taken[slots[k]] = 1;
+            }
+            if (k == size) break;
+            while (k-- > 0) taken[slots[k]] = 0;
+        }
+        if (d == maxDisplacement) {
+            placed = 0;
+            break;
+        }
+        displacements[b] = (uint32_t)d;
+        for (uint32_t k = 0; k < size; k++) {
+            positions[members[first[b] + k]] = slots[k];
+        }
+    }
+
+    free(hashes);
+    free(first);
+    free(members);
+    free(order);
+    free(taken);
+    return placed;
+}
+
+// Copie des tuples de la table, cumulée par iterateHashTable
+void collectTuple(t_hashtable* table, const t_tuple* tuple, void* context) {
+    (void)table;
+    t_tuple** tuples = context;
+    *(*tuples)++ = *tuple;
+}
+
+// Conversion d'une table chargée (chaînage ou robinhood) en table parfaite :
+// nbTuples cases exactement, une par clé, et un déplacement par seau. Les
+// définitions restent dans l'arène ; la table n'accepte plus d'insertion.
+void buildPerfectHash(t_hashtable* table) {
+    uint32_t n = table->nbTuples;
+    t_tuple* tuples = malloc((n + 1) * sizeof(t_tuple));
+    assert(tuples != NULL);
+    t_tuple* cursor = tuples;
+    iterateHashTable(table, collectTuple, &cursor);
+
+    table->nbBuckets = n > 0 ? (n + PERFECT_BUCKET_SIZE - 1) / PERFECT_BUCKET_SIZE : 1;
+    table->displacements = arenaAlloc(table->arena, table->nbBuckets * sizeof(uint32_t));
+    memset(table->displacements, 0, table->nbBuckets * sizeof(uint32_t));
+    uint32_t* positions = malloc((n + 1) * sizeof(uint32_t));
+    assert(positions != NULL);
+    uint32_t seed = 0;
+    while (n > 0 && !placePerfectKeys(table, tuples, n, seed, table->displacements, positions)) {
+        if (++seed == PERFECT_MAX_SEEDS) {
+            fprintf(stderr, "Erreur : construction du hachage parfait impossible (%d graines essayées).\n", PERFECT_MAX_SEEDS);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Une case par clé ; l'empreinte reste celle de la fonction -h (instantanés)
+    uint32_t nbSlots = n > 0 ? n : 1;
+    t_entry* entries = calloc(nbSlots, sizeof(t_entry));
+    assert(entries != NULL);
+    for (uint32_t i = 0; i < n; i++) {
+        t_entry* entry = &entries[positions[i]];
+        entry->hash = hashKey(table, fieldText(table, tuples[i].key), tuples[i].key.len);
+        entry->dist = 1;
+        entry->data = tuples[i];
+        setEntryKey(table, entry);
+    }
+    free(positions);
+    free(tuples);
+
+    free(table->slots);
+    free(table->oldSlots);
+    free(table->entries);
+    table->slots = NULL;
+    table->oldSlots = NULL;
+    table->entries = entries;
+    table->nbSlots = nbSlots;
+    table->perfectSeed = seed;
+    table->engine = ENGINE_PARFAIT;
+}
+
+// Positions d'une clé dans le filtre, tirées de mix64 (indépendant de la
+// fonction -h qui choisit l'alvéole) : le bloc par les 32 bits de poids fort,
+// les bits du bloc par double hachage h1 + i * h2 (h2 impair) sur les autres
+void addBloomKey(t_hashtable* table, const t_tuple* tuple, void* context) {
+    (void)context;
+    uint64_t hash = hashMix64(fieldText(table, tuple->key), tuple->key.len);
+    uint64_t* block = table->bloom + (hash >> 32) % (table->bloomBits / 512) * BLOOM_BLOCK_WORDS;
+    uint32_t bit = (uint32_t)hash;
+    uint32_t step = (bit >> 16) | 1;
+    for (int i = 0; i < table->bloomHashes; i++, bit += step) {
+        block[bit / 64 % BLOOM_BLOCK_WORDS] |= 1ULL << (bit % 64);
+    }
+}
+
+// Construction du filtre sur les clés chargées, pour un taux de faux positifs donné
+void buildBloomFilter(t_hashtable* table, double rate) {
+    double n = table->nbTuples > 0 ? table->nbTuples : 1;
+    double bits = ceil(-n * log(rate) / (M_LN2 * M_LN2));
+    int hashes = (int)lround(bits / n * M_LN2);
+    if (hashes < 1) hashes = 1;
+    if (hashes > BLOOM_MAX_HASHES) hashes = BLOOM_MAX_HASHES;
+    table->bloomBits = ((uint64_t)bits + 511) / 512 * 512;
+    table->bloomHashes = hashes;
+    table->bloom = calloc(table->bloomBits / 64, sizeof(uint64_t));
+    assert(table->bloom != NULL);
+    iterateHashTable(table, addBloomKey, NULL);
+}
+
+// La clé peut-elle être dans la table ? 0 : sûrement absente
+int bloomMayContain(const t_hashtable* table, const char* key, size_t len) {
+    uint64_t hash = hashMix64(key, len);
+    const uint64_t* block = table->bloom + (hash >> 32) % (table->bloomBits / 512) * BLOOM_BLOCK_WORDS;
+    uint32_t bit = (uint32_t)hash;
+    uint32_t step = (bit >> 16) | 1;
+    for (int i = 0; i < table->bloomHashes; i++, bit += step) {
+        if (!(block[bit / 64 % BLOOM_BLOCK_WORDS] & (1ULL << (bit % 64)))) return 0;
+    }
+    return 1;
+}
+
+// Ordre des octets, la clé la plus courte d'abord à préfixe égal
+int compareTrieKeys(const void* a, const void* b) {
+    const t_trieKey* first = a;
+    const t_trieKey* second = b;
+    int order = memcmp(first->text, second->text, first->len < second->len ? first->len : second->len);
+    if (order != 0) return order;
+    return (first->len > second->len) - (first->len < second->len);
+}
+
+// Ajout d'un nœud en fin de tableau, étiquette recopiée ; renvoie son indice
+uint32_t addTrieNode(t_trie* trie, const char* label, uint32_t labelLen) {
+    if (trie->nbNodes == trie->capacity) {
+        trie->capacity = trie->capacity ? 2 * trie->capacity : 1024;
+        trie->nodes = realloc(trie->nodes, trie->capacity * sizeof(t_trieNode));
+        assert(trie->nodes != NULL);
+    }
+    if (trie->labelsSize + labelLen > trie->labelsCapacity) {
+        while (trie->labelsSize + labelLen > trie->labelsCapacity) {
+            trie->labelsCapacity = trie->labelsCapacity ? 2 * trie->labelsCapacity : 4096;
+        }
+        trie->labels = realloc(trie->labels, trie->labelsCapacity);
+        assert(trie->labels != NULL);
+    }
+    t_trieNode* node = &trie->nodes[trie->nbNodes];
+    node->label = trie->labelsSize;
+    node->labelLen = labelLen;
+    node->end = trie->nbNodes + 1;
+    node->tuple = TRIE_NO_TUPLE;
+    memcpy(trie->labels + trie->labelsSize, label, labelLen);
+    trie->labelsSize += labelLen;
+    return trie->nbNodes++;
+}
+
+// Nœud des clés triées keys[begin, end[, qui ont en commun leurs depth premiers
+// octets : son étiquette est le reste de leur plus long préfixe commun (celui
+// de la première et de la dernière, puisqu'elles sont triées), ses enfants
+// regroupent les clés selon l'octet suivant
+void buildTrieNode(t_trie* trie, const t_trieKey* keys, uint32_t begin, uint32_t end, uint32_t depth) {
+    const t_trieKey* first = &keys[begin];
+    const t_trieKey* last = &keys[end - 1];
+    uint32_t common = depth;
+    while (common < first->len && common < last->len && first->text[common] == last->text[common]) common++;
+
+    uint32_t index = addTrieNode(trie, first->text + depth, common - depth);
+    if (first->len == common) {
+        trie->nodes[index].tuple = first->tuple;
+        begin++;
+    }
+    while (begin < end) {
+        uint32_t group = begin + 1;
+        while (group < end && keys[group].text[common] == keys[begin].text[common]) group++;
+        buildTrieNode(trie, keys, begin, group, common);
+        begin = group;
+    }
+    trie->nodes[index].end = trie->nbNodes;
+}
+
+// Construction de l'arbre sur les clés de la table (tuples recopiés dans l'ordre des clés)
+t_trie* buildTrie(t_hashtable* table) {
+    t_trie* trie = calloc(1, sizeof(t_trie));
+    assert(trie != NULL);
+    uint32_t n = table->nbTuples;
+    t_tuple* tuples = malloc((n + 1) * sizeof(t_tuple));
+    t_trieKey* keys = malloc((n + 1) * sizeof(t_trieKey));
+    assert(tuples != NULL && keys != NULL);
+    t_tuple* cursor = tuples;
+    iterateHashTable(table, collectTuple, &cursor);
+    for (uint32_t i = 0; i < n; i++) {
+        keys[i].text = fieldText(table, tuples[i].key);
+        keys[i].len = tuples[i].key.len;
+        keys[i].tuple = i;
+    }
+    qsort(keys, n, sizeof(t_trieKey), compareTrieKeys);
+
+    trie->tuples = malloc((n + 1) * sizeof(t_tuple));
+    assert(trie->tuples != NULL);
+    for (uint32_t i = 0; i < n; i++) {
+        trie->tuples[i] = tuples[keys[i].tuple];
+        keys[i].tuple = i;
+        if (keys[i].len > trie->maxKeyLen) trie->maxKeyLen = keys[i].len;
+    }
+    trie->nbTuples = n;
+    if (n > 0) {
+        buildTrieNode(trie, keys, 0, n, 0);
+    } else {
+        addTrieNode(trie, "", 0);
+    }
+    free(keys);
+    free(tuples);
+    return trie;
+}
+
+void freeTrie(t_trie* trie) {
+    free(trie->nodes);
+    free(trie->labels);
+    free(trie->tuples);
+    free(trie);
+}
+
+// Recherche exacte : descente depuis la racine, l'enfant suivi est celui dont
+// l'étiquette commence par l'octet suivant de la clé. comparisons compte les
+// étiquettes comparées, probes les nœuds examinés (frères compris).
+const t_tuple* lookupTrie(const t_trie* trie, const char* key, size_t len, int* comparisons, int* probes) {
+    *comparisons = 0;
+    *probes = 1;
+    uint32_t index = 0;
+    size_t position = 0;
+    while (1) {
+        const t_trieNode* node = &trie->nodes[index];
+        (*comparisons)++;
+        if (node->labelLen > len - position || memcmp(trie->labels + node->label, key + position, node->labelLen) != 0) {
+            return NULL;
+        }
+        position += node->labelLen;
+        if (position == len) {
+            return node->tuple != TRIE_NO_TUPLE ? &trie->tuples[node->tuple] : NULL;
+        }
+        uint32_t child = index + 1;
+        while (child < node->end && trie->labels[trie->nodes[child].label] != key[position]) {
+            child = trie->nodes[child].end;
+            (*probes)++;
+        }
+        if (child >= node->end) return NULL;
+        (*probes)++;
+        index = child;
+    }
+}
+
+// Nœud dont le sous-arbre contient toutes les clés commençant par prefix
+// (TRIE_NO_TUPLE s'il n'y en a aucune) ; *length reçoit la longueur des
+// chaînes qui s'arrêtent à ce nœud
+uint32_t findTriePrefix(const t_trie* trie, const char* prefix, size_t len, uint32_t* length) {
+    uint32_t index = 0;
+    size_t position = 0;
+    while (1) {
+        const t_trieNode* node = &trie->nodes[index];
+        size_t compared = node->labelLen < len - position ? node->labelLen : len - position;
+        if (memcmp(trie->labels + node->label, prefix + position, compared) != 0) return TRIE_NO_TUPLE;
+        if (compared < node->labelLen || position + compared == len) {
+            *length = position + node->labelLen;
+            return index;
+        }
+        position += node->labelLen;
+        uint32_t child = index + 1;
+        while (child < node->end && trie->labels[trie->nodes[child].label] != prefix[position]) {
+            child = trie->nodes[child].end;
+        }
+        if (child >= node->end) return TRIE_NO_TUPLE;
+        index = child;
+    }
+}
+
+// Complétions de prefix : indices des tuples dans results, renvoie leur nombre.
+// Sans limite (maxResults <= 0), toutes les clés du sous-arbre dans l'ordre des
+// octets. Sinon les maxResults plus courtes (à longueur égale, dans l'ordre des
+// octets) : parcours du meilleur d'abord avec un tas trié par (longueur, nœud),
+// les enfants d'un nœud étant toujours plus longs que lui.
+int completeTrie(const t_trie* trie, const char* prefix, size_t len, int maxResults, uint32_t* results) {
+    uint32_t length;
+    uint32_t start = findTriePrefix(trie, prefix, len, &length);
+    if (start == TRIE_NO_TUPLE) return 0;
+    int count = 0;
+    if (maxResults <= 0) {
+        for (uint32_t i = start; i < trie->nodes[start].end; i++) {
+            if (trie->nodes[i].tuple != TRIE_NO_TUPLE) results[count++] = trie->nodes[i].tuple;
+        }
+        return count;
+    }
+
+    size_t capacity = 64, size = 0;
+    uint64_t* heap = malloc(capacity * sizeof(uint64_t));  // (longueur << 32) | nœud
+    assert(heap != NULL);
+    heap[size++] = ((uint64_t)length << 32) | start;
+    while (size > 0 && count < maxResults) {
+        uint64_t top = heap[0];
+        heap[0] = heap[--size];
+        for (size_t i = 0; 2 * i + 1 < size; ) {
+            size_t child = 2 * i + 1;
+            if (child + 1 < size && heap[child + 1] < heap[child]) child++;
+            if (heap[i] <= heap[child]) break;
+            uint64_t swap = heap[i]; heap[i] = heap[child]; heap[child] = swap;
+            i = child;
+        }
+        uint32_t index = (uint32_t)top;
+        uint32_t depth = top >> 32;
+        const t_trieNode* node = &trie->nodes[index];
+        if (node->tuple != TRIE_NO_TUPLE) results[count++] = node->tuple;
+        for (uint32_t child = index + 1; child < node->end; child = trie->nodes[child].end) {
+            if (size == capacity) {
+                capacity *= 2;
+                heap = realloc(heap, capacity * sizeof(uint64_t));
+                assert(heap != NULL);
+            }
+            size_t i = size++;
+            heap[i] = ((uint64_t)(depth + trie->nodes[child].labelLen) << 32) | child;
+            while (i > 0 && heap[(i - 1) / 2] > heap[i]) {
+                uint64_t swap = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = swap;
+                i = (i - 1) / 2;
+            }
+        }
+    }
+    free(heap);
+    return count;
+}
+
+// Affichage des complétions d'un préfixe (option -a, limitées par -k)
+void printCompletions(const t_trie* trie, t_hashtable* table, const char* prefix, int maxResults) {
+    size_t len = strlen(prefix);
+    char buffer[len + 1];
+    const char* normalized = normalizeKey(table->normalization, prefix, &len, buffer);
+    uint32_t* results = malloc((trie->nbTuples + 1) * sizeof(uint32_t));
+    assert(results != NULL);
+    double start = now();
+    int count = completeTrie(trie, normalized, len, maxResults, results);
+    double elapsed = now() - start;
+    if (maxResults > 0) {
+        printf("%d complétion(s) la(les) plus courte(s) de « %s » (%.3f ms) :\n", count, prefix, elapsed * 1000);
+    } else {
+        printf("%d clé(s) commençant par « %s » (%.3f ms) :\n", count, prefix, elapsed * 1000);
+    }
+    for (int i = 0; i < count; i++) {
+        t_view key = trie->tuples[results[i]].key;
+        printf("  %.*s\n", (int)key.len, fieldText(table, key));
+    }
+    free(results);
+}
+
+// Occupation mémoire de l'arbre comparée à celle de la table sur les mêmes clés :
+// nœuds, étiquettes et tuples d'un côté ; alvéoles ou cases, nœuds et octets
+// des clés de l'autre (les définitions, communes aux deux, ne sont pas comptées)
+void trieReport(const t_trie* trie, t_hashtable* table, double buildTime) {
+    long nodeBytes = trie->nbNodes * (long)sizeof(t_trieNode);
+    long tupleBytes = trie->nbTuples * (long)sizeof(t_tuple);
+    long trieBytes = nodeBytes + (long)trie->labelsSize + tupleBytes;
+    long keyBytes = 0;
+    for (uint32_t i = 0; i < trie->nbTuples; i++) {
+        keyBytes += trie->tuples[i].key.len;
+    }
+    long slotBytes = table->engine == ENGINE_CHAINAGE ? table->nbSlots * (long)sizeof(t_node*)
+                                                      : table->nbSlots * (long)sizeof(t_entry);
+    long tableNodeBytes = table->engine == ENGINE_CHAINAGE ? table->nbTuples * (long)sizeof(t_node) : 0;
+    long tableBytes = slotBytes + tableNodeBytes + keyBytes;
+    printf("trie : %u clés, %u nœuds, %ld octets (nœuds %ld, étiquettes %zu, tuples %ld), construit en %.1f ms\n",
+        trie->nbTuples, trie->nbNodes, trieBytes, nodeBytes, trie->labelsSize, tupleBytes, buildTime * 1000);
+    printf("table (%s) : %ld octets (alvéoles %ld, nœuds %ld, clés %ld)\n",
+        engineName(table->engine), tableBytes, slotBytes, tableNodeBytes, keyBytes);
+    printf("étiquettes / clés : %.2f, trie / table : %.2f\n",
+        keyBytes > 0 ? (double)trie->labelsSize / keyBytes : 0, tableBytes > 0 ? (double)trieBytes / tableBytes : 0);
+}
+
+// Recherche par lot dans l'arbre (mêmes requêtes que la table, -q avec -trie)
+void runTrieBatch(const t_trie* trie, t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet) {
+    int found = 0;
+    long totalComparisons = 0, totalProbes = 0;
+    double start = now();
+    for (int q = 0; q < nbQueries; q++) {
+        size_t len = strlen(queries[q]);
+        char buffer[len + 1];
+        const char* key = normalizeKey(table->normalization, queries[q], &len, buffer);
+        int comparisons, probes;
+        const t_tuple* tuple = lookupTrie(trie, key, len, &comparisons, &probes);
+        if (!quiet) printSearchResult(table, stdout, metadata, queries[q], tuple, comparisons, probes);
+        if (tuple) found++;
+        totalComparisons += comparisons;
+        totalProbes += probes;
+    }
+    double elapsed = now() - start;
+    printf("trie : %d requêtes en %.3f ms (%.1f ns par recherche), trouvés : %d, absents : %d\n",
+        nbQueries, elapsed * 1000, nbQueries > 0 ? elapsed * 1e9 / nbQueries : 0, found, nbQueries - found);
+    printf("  étiquettes comparées : moyenne %.2f, nœuds examinés : moyenne %.2f\n",
+        nbQueries > 0 ? (double)totalComparisons / nbQueries : 0, nbQueries > 0 ? (double)totalProbes / nbQueries : 0);
+}
+
+// Descente dans le nœud index, depth octets sous la racine : une ligne de
+// distances par octet de l'étiquette, puis la clé du nœud si elle est assez
+// proche, puis les enfants
+void fuzzyVisit(t_fuzzySearch* search, uint32_t index, uint32_t depth) {
+    const t_trieNode* node = &search->trie->nodes[index];
+    const char* label = search->trie->labels + node->label;
+    size_t len = search->len;
+    for (uint32_t b = 0; b < node->labelLen; b++, depth++) {
+        const int* previous = search->rows + depth * (len + 1);
+        int* next = search->rows + (depth + 1) * (len + 1);
+        next[0] = previous[0] + 1;
+        int rowMinimum = next[0];
+        for (size_t j = 1; j <= len; j++) {
+            int substitution = previous[j - 1] + (search->key[j - 1] != label[b]);
+            int insertion = previous[j] + 1;
+            int deletion = next[j - 1] + 1;
+            int distance = substitution < insertion ? substitution : insertion;
+            next[j] = deletion < distance ? deletion : distance;
+            if (next[j] < rowMinimum) rowMinimum = next[j];
+        }
+        if (rowMinimum > search->maxDistance) return;
+    }
+    int distance = search->rows[depth * (len + 1) + len];
+    if (node->tuple != TRIE_NO_TUPLE && distance <= search->maxDistance) {
+        if (search->nbFound == search->capacity) {
+            search->capacity = search->capacity ? 2 * search->capacity : 16;
+            search->found = realloc(search->found, search->capacity * sizeof(t_suggestion));
+            assert(search->found != NULL);
+        }
+        search->found[search->nbFound].tuple = node->tuple;
+        search->found[search->nbFound].distance = distance;
+        search->nbFound++;
+    }
+    for (uint32_t child = index + 1; child < node->end; child = search->trie->nodes[child].end) {
+        fuzzyVisit(search, child, depth);
+    }
+}
+
+// Les plus proches d'abord, puis dans l'ordre des clés
+int compareSuggestions(const void* a, const void* b) {
+    const t_suggestion* first = a;
+    const t_suggestion* second = b;
+    if (first->distance != second->distance) return first->distance - second->distance;
+    return (first->tuple > second->tuple) - (first->tuple < second->tuple);
+}
+
+int compareDoubles(const void* a, const void* b) {
+    double first = *(const double*)a;
+    double second = *(const double*)b;
+    return (first > second) - (first < second);
+}
+
+// Au plus maxResults clés à distance au plus maxDistance de key, les plus
+// proches d'abord ; renvoie leur nombre
+int suggestTrie(const t_trie* trie, const char* key, size_t len, int maxDistance, int maxResults, t_suggestion* results) {
+    t_fuzzySearch search = { trie, key, len, maxDistance, NULL, NULL, 0, 0 };
+    search.rows = malloc((trie->maxKeyLen + 1) * (len + 1) * sizeof(int));
+    assert(search.rows != NULL);
+    for (size_t j = 0; j <= len; j++) {
+        search.rows[j] = j;
+    }
+    fuzzyVisit(&search, 0, 0);
+    qsort(search.found, search.nbFound, sizeof(t_suggestion), compareSuggestions);
+    int count = search.nbFound < maxResults ? search.nbFound : maxResults;
+    if (count > 0) memcpy(results, search.found, count * sizeof(t_suggestion));
+    free(search.found);
+    free(search.rows);
+    return count;
+}
+
+// « Vouliez-vous dire » après une recherche infructueuse
+void printSuggestions(const t_trie* trie, t_hashtable* table, FILE* output, const char* key, int maxDistance, int maxResults) {
+    size_t len = strlen(key);
+    char buffer[len + 1];
+    const char* normalized = normalizeKey(table->normalization, key, &len, buffer);
+    t_suggestion results[maxResults];
+    int count = suggestTrie(trie, normalized, len, maxDistance, maxResults, results);
+    if (count == 0) {
+        fprintf(output, "  Aucune clé à distance %d ou moins de %s.\n", maxDistance, key);
+        return;
+    }
+    fprintf(output, "  Vouliez-vous dire : ");
+    for (int i = 0; i < count; i++) {
+        t_view suggestion = trie->tuples[results[i].tuple].key;
+        fprintf(output, "%.*s (%d)%s", (int)suggestion.len, fieldText(table, suggestion), results[i].distance, i == count - 1 ? " ?\n" : ", ");
+    }
+}
+
+// Suggestions pour toutes les requêtes absentes d'un lot, avec la latence de
+// chaque recherche approchée (moyenne, médiane, 99e centile, maximum)
+void suggestionReport(const t_trie* trie, t_hashtable* table, char** queries, int nbQueries, int quiet, int maxDistance, int maxResults) {
+    double* latencies = malloc((nbQueries + 1) * sizeof(double));
+    assert(latencies != NULL);
+    int nbMisses = 0, nbSuggested = 0;
+    double total = 0;
+    for (int q = 0; q < nbQueries; q++) {
+        size_t len = strlen(queries[q]);
+        char buffer[len + 1];
+        const char* key = normalizeKey(table->normalization, queries[q], &len, buffer);
+        int comparisons, probes;
+        if (lookupHash(table, key, len, hashKey(table, key, len), &comparisons, &probes)) continue;
+
+        t_suggestion results[maxResults];
+        double start = now();
+        int count = suggestTrie(trie, key, len, maxDistance, maxResults, results);
+        double elapsed = now() - start;
+        latencies[nbMisses++] = elapsed;
+        total += elapsed;
+        if (count > 0) nbSuggested++;
+        if (!quiet) {
+            printf("Suggestions pour %s :", queries[q]);
+            for (int i = 0; i < count; i++) {
+                t_view suggestion = trie->tuples[results[i].tuple].key;
+                printf(" %.*s (%d)", (int)suggestion.len, fieldText(table, suggestion), results[i].distance);
+            }
+            printf(count > 0 ? "\n" : " aucune\n");
+        }
+    }
+    qsort(latencies, nbMisses, sizeof(double), compareDoubles);
+    printf("suggestions (distance <= %d) : %d absents, %d avec au moins une suggestion\n", maxDistance, nbMisses, nbSuggested);
+    if (nbMisses > 0) {
+        printf("  latence : moyenne %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", total * 1e6 / nbMisses,
+            latencies[nbMisses / 2] * 1e6, latencies[(int)(nbMisses * 0.99)] * 1e6, latencies[nbMisses - 1] * 1e6);
+    }
+    free(latencies);
+}
+
+// Nom d'un moteur de table (option -e)
+const char* engineName(int engine) {
+    if (engine == ENGINE_CHAINAGE) return "chainage";
+    if (engine == ENGINE_ROBINHOOD) return "robinhood";
+    return "parfait";
+}
+
+// Affichage des définitions d'un tuple
+void printTuple(t_hashtable* table, FILE* output, t_metadata* metadata, const t_tuple* tuple) {
+    fprintf(output, "mot : %.*s\n", (int)tuple->key.len, fieldText(table, tuple->key));
+    for (int d = 0; d < tuple->nbDefinitions; d++) {
+        fprintf(output, "Définition %d :\n", d + 1);
+        for (int j = 0; j < metadata->nbFields - 1; j++) {
+            t_view field = definitionField(tuple->definitions[d], metadata->nbFields, j);
+            if (field.len > 0) {
+                fprintf(output, "  %s : %.*s\n", metadata->fieldNames[j + 1], (int)field.len, fieldText(table, field));
+            } else {
+                fprintf(output, "  %s : X\n", metadata->fieldNames[j + 1]);
+            }
+        }
+        fprintf(output, "\n");
+    }
+}
+
+// Affichage du résultat d'une recherche (tuple vaut NULL en cas d'échec)
+void printSearchResult(t_hashtable* table, FILE* output, t_metadata* metadata, const char* key, const t_tuple* tuple, int comparisons, int probes) {
+    fprintf(output, "Recherche de %s : %s ! nb comparaisons : %d, nb sondages : %d\n", key, tuple ? "trouvé" : "échec", comparisons, probes);
+    if (tuple) printTuple(table, output, metadata, tuple);
+}
+
+// Recherche d'une clé dans la table de hachage
+int searchKeyHash(t_hashtable* table, t_metadata* metadata, const char* key, int* comparisons, int* probes) {
+    size_t len = strlen(key);
+    char buffer[len + 1];
+    const char* normalized = normalizeKey(table->normalization, key, &len, buffer);
+    t_tuple* tuple = lookupHash(table, normalized, len, hashKey(table, normalized, len), comparisons, probes);
+    printSearchResult(table, stdout, metadata, key, tuple, *comparisons, *probes);
+    return tuple != NULL;
+}
+
+// Lecture d'un fichier de requêtes (un mot par ligne, lignes vides ignorées)
+char** readQueries(const char* filename, t_arena* arena, int* nbQueries) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        perror("Erreur d'ouverture du fichier de requêtes");
+        exit(EXIT_FAILURE);
+    }
+    int size = 1024;
+    char** queries = malloc(size * sizeof(char*));
+    assert(queries != NULL);
+    *nbQueries = 0;
+
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = readLine(file, &line, &capacity)) >= 0) {
+        if (len > 0) {
+            if (*nbQueries >= size) {
+                size *= 2;
+                queries = realloc(queries, size * sizeof(char*));
+                assert(queries != NULL);
+            }
+            char* query = arenaAlloc(arena, len + 1);
+            memcpy(query, line, len + 1);
+            queries[(*nbQueries)++] = query;
+        }
+    }
+    free(line);
+    fclose(file);
+    return queries;
+}
+
+// Recherche des requêtes d'une tranche ; les résultats sont écrits dans output
+// sauf en mode muet. Aucune écriture dans la table : plusieurs tranches peuvent
+// être traitées en même temps sur la même table.
+void searchBatch(t_batch* batch, FILE* output) {
+    batch->found = 0;
+    batch->maxComparisons = batch->maxProbes = 0;
+    batch->totalComparisons = batch->totalProbes = 0;
+    batch->rejected = batch->falsePositives = 0;
+    for (int q = batch->begin; q < batch->end; q++) {
+        const char* key = batch->queries[q];
+        size_t len = strlen(key);
+        char buffer[len + 1];
+        const char* normalized = normalizeKey(batch->table->normalization, key, &len, buffer);
+        int comparisons = 0, probes = 0;
+        // Même chemin que lookupHash, détaillé pour compter les rejets du filtre
+        int rejected = batch->table->bloom && !bloomMayContain(batch->table, normalized, len);
+        t_tuple* tuple = rejected ? NULL : probeTable(batch->table, normalized, len, hashKey(batch->table, normalized, len), &comparisons, &probes);
+        if (!batch->quiet) printSearchResult(batch->table, output, batch->metadata, key, tuple, comparisons, probes);
+        if (tuple) batch->found++;
+        batch->rejected += rejected;
+        if (!tuple && !rejected && batch->table->bloom) batch->falsePositives++;
+        batch->totalComparisons += comparisons;
+        batch->totalProbes += probes;
+        if (comparisons > batch->maxComparisons) batch->maxComparisons = comparisons;
+        if (probes > batch->maxProbes) batch->maxProbes = probes;
+    }
+}
+
+// Bilan d'un lot : temps total, débit, trouvés/absents, comparaisons et sondages
+void printBatchSummary(const t_batch* batch, int nbQueries, double elapsed) {
+    printf("%d requêtes en %.3f ms (%.0f recherches/s)\n", nbQueries, elapsed * 1000, elapsed > 0 ? nbQueries / elapsed : 0);
+    printf("  trouvés : %d, absents : %d\n", batch->found, nbQueries - batch->found);
+    printf("  comparaisons : moyenne %.2f, max %d\n", nbQueries > 0 ? (double)batch->totalComparisons / nbQueries : 0, batch->maxComparisons);
+    printf("  sondages : moyenne %.2f, max %d\n", nbQueries > 0 ? (double)batch->totalProbes / nbQueries : 0, batch->maxProbes);
+    printf("  coût : %.1f ns par recherche, %.1f ns par sondage\n", nbQueries > 0 ? elapsed * 1e9 / nbQueries : 0,
+        batch->totalProbes > 0 ? elapsed * 1e9 / batch->totalProbes : 0);
+    if (batch->table->bloom) {
+        int absent = nbQueries - batch->found;
+        printf("  filtre : %d absents écartés sans sondage (%.1f %%), %d faux positifs (%.2f %% des absents)\n",
+            batch->rejected, absent > 0 ? 100.0 * batch->rejected / absent : 0,
+            batch->falsePositives, absent > 0 ? 100.0 * batch->falsePositives / absent : 0);
+    }
+}
+
+// Recherche de toutes les requêtes sur le thread courant, puis bilan (hachage compris).
+// En mode muet, seul le bilan est affiché : les entrées-sorties ne faussent pas la mesure.
+void runBatch(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet) {
+    t_batch batch = { table, metadata, queries, 0, nbQueries, quiet, NULL, 0, 0, 0, 0, 0, 0, 0, 0 };
+    double start = now();
+    searchBatch(&batch, stdout);
+    double elapsed = now() - start;
+    printBatchSummary(&batch, nbQueries, elapsed);
+}
+
+// Thread de recherche : traite sa tranche dans son propre tampon de sortie
+void* batchWorker(void* arg) {
+    t_batch* batch = arg;
+    FILE* output = NULL;
+    if (!batch->quiet) {
+        output = open_memstream(&batch->buffer, &batch->bufferSize);
+        assert(output != NULL);
+    }
+    searchBatch(batch, output);
+    if (output) fclose(output);
+    return NULL;
+}
+
+// Recherche des requêtes découpées en nbThreads tranches contiguës traitées en
+// parallèle sur la table partagée (construite, donc plus modifiée). Les tampons
+// sont recopiés dans l'ordre des tranches : la sortie suit l'ordre des requêtes.
+// Renvoie le temps écoulé entre le lancement des threads et la fin du dernier.
+double runParallelBatch(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet, int nbThreads, int printResults) {
+    t_batch batches[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+
+    double start = now();
+    for (int t = 0; t < nbThreads; t++) {
+        t_batch batch = { table, metadata, queries, (int)((long)nbQueries * t / nbThreads),
+            (int)((long)nbQueries * (t + 1) / nbThreads), quiet, NULL, 0, 0, 0, 0, 0, 0, 0, 0 };
+        batches[t] = batch;
+        if (pthread_create(&threads[t], NULL, batchWorker, &batches[t]) != 0) {
+            fprintf(stderr, "Erreur : création du thread %d impossible.\n", t + 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < nbThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now() - start;
+
+    // Fusion des tampons et des compteurs dans l'ordre des tranches
+    t_batch total = { table, metadata, queries, 0, nbQueries, quiet, NULL, 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (int t = 0; t < nbThreads; t++) {
+        if (batches[t].buffer) {
+            if (printResults) fwrite(batches[t].buffer, 1, batches[t].bufferSize, stdout);
+            free(batches[t].buffer);
+        }
+        total.found += batches[t].found;
+        total.totalComparisons += batches[t].totalComparisons;
+        total.totalProbes += batches[t].totalProbes;
+        total.rejected += batches[t].rejected;
+        total.falsePositives += batches[t].falsePositives;
+        if (batches[t].maxComparisons > total.maxComparisons) total.maxComparisons = batches[t].maxComparisons;
+        if (batches[t].maxProbes > total.maxProbes) total.maxProbes = batches[t].maxProbes;
+    }
+    if (printResults) printBatchSummary(&total, nbQueries, elapsed);
+    return elapsed;
+}
+
+// Passage à l'échelle : le même lot pour chaque nombre de threads demandé.
+// Les résultats et le bilan détaillé ne sont affichés que pour le premier passage.
+void parallelScalingReport(t_hashtable* table, t_metadata* metadata, char** queries, int nbQueries, int quiet, const int* threadCounts, int nbCounts) {
+    double times[MAX_THREADS];
+    for (int i = 0; i < nbCounts; i++) {
+        times[i] = runParallelBatch(table, metadata, queries, nbQueries, quiet, threadCounts[i], i == 0);
+    }
+    printf("\n%8s %12s %16s %10s\n", "threads", "temps (ms)", "recherches/s", "gain");
+    for (int i = 0; i < nbCounts; i++) {
+        printf("%8d %12.3f %16.0f %10.2f\n", threadCounts[i], times[i] * 1000,
+            times[i] > 0 ? nbQueries / times[i] : 0, times[i] > 0 ? times[0] / times[i] : 0);
+    }
+}
+
+// Ligne CSV d'un banc d'essai, mêmes colonnes que prog1 et prog2 (en-tête
+// écrit par make bench). La mémoire est le pic du processus (getrusage) ;
+// latencies est trié sur place.
+void printCsvRow(const char* engine, const char* tableFile, const char* queryFile, int nbKeys, int nbQueries, int found, double buildTime, double* latencies) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double total = 0;
+    for (int q = 0; q < nbQueries; q++) total += latencies[q];
+    qsort(latencies, nbQueries, sizeof(double), compareDoubles);
+    printf("prog3,%s,%s,%s,%d,%d,%d,%.3f,%ld", engine, tableFile, queryFile, nbKeys, nbQueries, found, buildTime * 1000, usage.ru_maxrss);
+    if (nbQueries > 0) {
+        printf(",%.0f,%.0f,%.0f,%.0f,%.0f\n", total * 1e9 / nbQueries, latencies[nbQueries / 2] * 1e9,
+            latencies[(int)(nbQueries * 0.9)] * 1e9, latencies[(int)(nbQueries * 0.99)] * 1e9, latencies[nbQueries - 1] * 1e9);
+    } else {
+        printf(",0,0,0,0,0\n");
+    }
+}
+
+// Latence de chaque recherche (normalisation et hachage compris), dans la
+// table ou dans l'arbre si trie n'est pas NULL, puis la ligne CSV. Une seule
+// lecture d'horloge par requête : la fin d'une recherche est le début de la suivante.
+void csvReport(t_hashtable* table, const t_trie* trie, const char* tableFile, const char* queryFile, char** queries, int nbQueries, double buildTime) {
+    double* latencies = malloc((nbQueries + 1) * sizeof(double));
+    assert(latencies != NULL);
+    int found = 0;
+    double previous = now();
+    for (int q = 0; q < nbQueries; q++) {
+        size_t len = strlen(queries[q]);
+        char buffer[len + 1];
+        const char* key = normalizeKey(table->normalization, queries[q], &len, buffer);
+        int comparisons, probes;
+        const t_tuple* tuple = trie ? lookupTrie(trie, key, len, &comparisons, &probes)
+                                    : lookupHash(table, key, len, hashKey(table, key, len), &comparisons, &probes);
+        double end = now();
+        latencies[q] = end - previous;
+        previous = end;
+        if (tuple) found++;
+    }
+    char engine[32];
+    snprintf(engine, sizeof(engine), "%s%s", trie ? "trie" : engineName(table->engine), !trie && table->bloom ? "+filtre" : "");
+    printCsvRow(engine, tableFile, queryFile, table->nbTuples, nbQueries, found, buildTime, latencies);
+    free(latencies);
+}
+
+// Thread de chargement de la charge mixte
+void* loaderThread(void* arg) {
+    t_loader* loader = arg;
+    parseFileHashMmap(loader->filename, loader->metadata, loader->table, 1);
+    __atomic_store_n(&loader->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Lecteur de la charge mixte : les requêtes en boucle tant que le chargement dure
+void* readerThread(void* arg) {
+    t_reader* reader = arg;
+    while (reader->nbQueries > 0) {
+        for (int q = 0; q < reader->nbQueries; q++) {
+            if (__atomic_load_n(reader->done, __ATOMIC_ACQUIRE)) return NULL;
+            size_t len = strlen(reader->queries[q]);
+            char buffer[len + 1];
+            const char* key = normalizeKey(reader->table->normalization, reader->queries[q], &len, buffer);
+            int comparisons, probes;
+            if (lookupHash(reader->table, key, len, hashKey(reader->table, key, len), &comparisons, &probes)) {
+                reader->found++;
+            }
+            reader->lookups++;
+        }
+    }
+    return NULL;
+}
+
+// Débit en charge mixte : pour chaque nombre de lecteurs, une table concurrente
+// est chargée par un thread pendant que les lecteurs la consultent. Les débits
+// sont rapportés à la durée du chargement ; le taux de réussite croît avec le
+// remplissage de la table.
+void mixedWorkloadReport(const char* filename, int nbSlots, hashFunction hashFunc, double maxLoad, int normalization, char** queries, int nbQueries, const int* readerCounts, int nbCounts) {
+    printf("%8s %16s %14s %16s %10s\n", "lecteurs", "chargement (ms)", "insertions/s", "recherches/s", "trouvés");
+    for (int i = 0; i < nbCounts; i++) {
+        t_metadata metadata;
+        t_hashtable* table = createHashTable(ENGINE_CHAINAGE, nbSlots, hashFunc);
+        if (maxLoad > 0) table->maxLoad = maxLoad;
+        if (normalization >= 0) table->normalization = normalization;
+        table->verbose = 0;
+        enableConcurrency(table);
+
+        t_loader loader = { table, &metadata, filename, 0 };
+        t_reader readers[MAX_THREADS];
+        pthread_t threads[MAX_THREADS];
+        pthread_t loading;
+        double start = now();
+        if (pthread_create(&loading, NULL, loaderThread, &loader) != 0) {
+            fprintf(stderr, "Erreur : création du thread de chargement impossible.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int t = 0; t < readerCounts[i]; t++) {
+            t_reader reader = { table, queries, nbQueries, &loader.done, 0, 0 };
+            readers[t] = reader;
+            if (pthread_create(&threads[t], NULL, readerThread, &readers[t]) != 0) {
+                fprintf(stderr, "Erreur : création du thread %d impossible.\n", t + 1);
+                exit(EXIT_FAILURE);
+            }
+        }
+        pthread_join(loading, NULL);
+        double elapsed = now() - start;
+        long lookups = 0, found = 0;
+        for (int t = 0; t < readerCounts[i]; t++) {
+            pthread_join(threads[t], NULL);
+            lookups += readers[t].lookups;
+            found += readers[t].found;
+        }
+
+        printf("%8d %16.3f %14.0f %16.0f %9.1f%%\n", readerCounts[i], elapsed * 1000,
+            elapsed > 0 ? table->nbTuples / elapsed : 0, elapsed > 0 ? lookups / elapsed : 0,
+            lookups > 0 ? 100.0 * found / lookups : 0);
+        freeHashTable(table, &metadata);
+    }
+}
+
+// Lecture d'une liste de nombres de threads séparés par des virgules (minimum à
+// MAX_THREADS) dans counts. Renvoie le nombre de valeurs, -1 si la liste est invalide.
+int parseThreadList(const char* list, int* counts, int minimum) {
+    int nbCounts = 0;
+    while (*list) {
+        char* end;
+        long count = strtol(list, &end, 10);
+        if (end == list || count < minimum || count > MAX_THREADS || nbCounts == MAX_THREADS || (*end && *end != ',')) {
+            return -1;
+        }
+        counts[nbCounts++] = (int)count;
+        list = *end ? end + 1 : end;
+    }
+    return nbCounts;
+}
+
+// Longueur moyenne de sondage d'une recherche fructueuse (clé présente)
+double averageProbeLength(t_hashtable* table) {
+    if (table->nbTuples == 0) return 0;
+    long total = 0;
+    if (table->engine == ENGINE_CHAINAGE) {
+        // Le k-ième nœud d'une liste est atteint en k sondages
+        for (int i = 0; i < table->nbSlots; i++) {
+            int position = 0;
+            for (t_node* current = table->slots[i]; current; current = current->next) {
+                total += ++position;
+            }
+        }
+    } else {
+        for (int i = 0; i < table->nbSlots; i++) {
+            total += table->entries[i].dist;
+        }
+    }
+    return (double)total / table->nbTuples;
+}
+
+// Libération de la mémoire : nœuds et définitions partent avec l'arène
+void freeHashTable(t_hashtable* table, t_metadata* metadata) {
+    freeArena(table->arena);
+    free(table->oldSlots);
+    free(table->entries);
+    free(table->bloom);
+    if (table->concurrent) {
+        // Alvéoles dans l'arène, texte éventuellement réservé par appendText
+        if (table->textCapacity > 0) munmap(table->text, table->textCapacity);
+        else if (table->text) munmap(table->text, table->textSize);
+        pthread_mutex_destroy(&table->writeLock);
+        table->slots = NULL;
+    } else if (table->textCapacity > 0) {
+        free(table->text);
+    } else if (table->text) {
+        munmap(table->text, table->textSize);
+    }
+    free(table->slots);
+    for (int i = 0; i < metadata->nbFields; i++) {
+        free(metadata->fieldNames[i]);
+    }
+    free(metadata->fieldNames);
+    free(table);
+}
+
+// Horloge monotone en secondes
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Parcours de tous les tuples de la table (ordre des alvéoles)
+void iterateHashTable(t_hashtable* table, void (*visit)(t_hashtable*, const t_tuple*, void*), void* context) {
     for (int i = 0; i < table->nbSlots; i++) {
-        t_node* current = table->slots[i];
-        while (current) {
-            fprintf(output, "%s", current->data.key);
-            for (int d = 0; d < current->data.nbDefinitions; d++) {
-                for (int j = 0; j < metadata->nbFields - 1; j++) {
-                    fprintf(output, "%c%s", metadata->sep, current->data.definitions[d][j]);
+        if (table->engine == ENGINE_CHAINAGE) {
+            for (t_node* current = table->slots[i]; current; current = current->next) {
+                visit(table, &current->data, context);
+            }
+        } else if (table->entries[i].dist != 0) {
+            visit(table, &table->entries[i].data, context);
+        }
+    }
+}
+
+void collectKey(t_hashtable* table, const t_tuple* tuple, void* context) {
+    (void)table;
+    t_view** keys = context;
+    *(*keys)++ = tuple->key;
+}
+
+// Copie des vues de toutes les clés de la table dans keys (nbTuples cases)
+void collectKeys(t_hashtable* table, t_view* keys) {
+    iterateHashTable(table, collectKey, &keys);
+}
+
+// Occupation mémoire des tuples, cumulée par iterateHashTable
+typedef struct {
+    int nbFields;
+    long keyBytes;        // Octets des clés dans le texte
+    long fieldBytes;      // Octets des champs dans le texte
+    long definitionBytes; // Tableaux de définitions, bitmaps et vues des champs non vides
+    long nbDefinitions;
+} t_memoryStats;
+
+void measureTuple(t_hashtable* table, const t_tuple* tuple, void* context) {
+    (void)table;
+    t_memoryStats* stats = context;
+    stats->keyBytes += tuple->key.len;
+    stats->nbDefinitions += tuple->nbDefinitions;
+    stats->definitionBytes += tuple->capacity * sizeof(uint64_t*);
+    for (int d = 0; d < tuple->nbDefinitions; d++) {
+        int count = definitionCount(tuple->definitions[d], stats->nbFields);
+        const t_view* values = (const t_view*)(tuple->definitions[d] + fieldWords(stats->nbFields));
+        stats->definitionBytes += fieldWords(stats->nbFields) * sizeof(uint64_t) + count * sizeof(t_view);
+        for (int j = 0; j < count; j++) {
+            stats->fieldBytes += values[j].len;
+        }
+    }
+}
+
+// Statistiques au format nom=valeur (une par ligne) pour suivre la table dans le
+// temps : remplissage, longueurs des listes (distances à la case d'origine en
+// robinhood), mémoire par composant et temps de construction
+void printStats(t_hashtable* table, t_metadata* metadata, const char* inputFile, const char* hashName, double buildTime) {
+    // Longueur de chaque liste, ou distance de chaque case occupée
+    int maxLength = 0;
+    int* lengths = malloc(table->nbSlots * sizeof(int));
+    assert(lengths != NULL);
+    for (int i = 0; i < table->nbSlots; i++) {
+        int length = 0;
+        if (table->engine == ENGINE_CHAINAGE) {
+            for (t_node* current = table->slots[i]; current; current = current->next) length++;
+        } else {
+            length = table->entries[i].dist;
+        }
+        lengths[i] = length;
+        if (length > maxLength) maxLength = length;
+    }
+    long* histogram = calloc(maxLength + 1, sizeof(long));
+    assert(histogram != NULL);
+    for (int i = 0; i < table->nbSlots; i++) {
+        histogram[lengths[i]]++;
+    }
+    free(lengths);
+
+    // Percentiles sur les alvéoles (chaînage) ou sur les cases occupées (robinhood)
+    long population = table->engine == ENGINE_CHAINAGE ? table->nbSlots : table->nbTuples;
+    int first = table->engine == ENGINE_CHAINAGE ? 0 : 1;
+    int p50 = 0, p99 = 0;
+    long cumulated = 0;
+    for (int length = first; length <= maxLength; length++) {
+        cumulated += histogram[length];
+        if (cumulated * 100 < population * 50) p50 = length + 1;
+        if (cumulated * 100 < population * 99) p99 = length + 1;
+    }
+    if (p50 > maxLength) p50 = maxLength;
+    if (p99 > maxLength) p99 = maxLength;
+
+    t_memoryStats memory = { metadata->nbFields, 0, 0, 0, 0 };
+    iterateHashTable(table, measureTuple, &memory);
+    long slotBytes = table->engine == ENGINE_CHAINAGE ? table->nbSlots * (long)sizeof(t_node*)
+                                                      : table->nbSlots * (long)sizeof(t_entry);
+    slotBytes += table->nbBuckets * (long)sizeof(uint32_t);
+    long nodeBytes = table->engine == ENGINE_CHAINAGE ? table->nbTuples * (long)sizeof(t_node) : 0;
+
+    printf("fichier=%s\n", inputFile);
+    printf("moteur=%s\n", engineName(table->engine));
+    printf("fonction=%s\n", hashName);
+    printf("normalisation=%s\n", normalizationName(table->normalization));
+    printf("nb_tuples=%d\n", table->nbTuples);
+    printf("nb_definitions=%ld\n", memory.nbDefinitions);
+    printf("nb_alveoles=%d\n", table->nbSlots);
+    printf("taux_remplissage=%.4f\n", (double)table->nbTuples / table->nbSlots);
+    printf("alveoles_vides=%.4f\n", (double)histogram[0] / table->nbSlots);
+    printf("sondage_moyen=%.4f\n", averageProbeLength(table));
+    printf("%s_p50=%d\n", table->engine == ENGINE_CHAINAGE ? "longueur" : "distance", p50);
+    printf("%s_p99=%d\n", table->engine == ENGINE_CHAINAGE ? "longueur" : "distance", p99);
+    printf("%s_max=%d\n", table->engine == ENGINE_CHAINAGE ? "longueur" : "distance", maxLength);
+    for (int length = first; length <= maxLength; length++) {
+        if (histogram[length] > 0) printf("histogramme_%d=%ld\n", length, histogram[length]);
+    }
+    printf("memoire_alveoles=%ld\n", slotBytes);
+    printf("memoire_noeuds=%ld\n", nodeBytes);
+    printf("memoire_cles=%ld\n", memory.keyBytes);
+    printf("memoire_definitions=%ld\n", memory.definitionBytes);
+    printf("memoire_champs=%ld\n", memory.fieldBytes);
+    printf("memoire_arene=%zu\n", table->arena->allocated);
+    printf("memoire_filtre=%lu\n", (unsigned long)(table->bloomBits / 8));
+    if (table->bloom) printf("filtre_positions=%d\n", table->bloomHashes);
+    printf("memoire_texte=%zu\n", table->textCapacity > 0 ? table->textCapacity : table->textSize);
+    printf("texte_projete=%d\n", table->textCapacity == 0);
+    printf("temps_construction_ms=%.3f\n", buildTime * 1000);
+    free(histogram);
+}
+
+// Comparaison des fonctions de hachage sur les clés de la table : répartition
+// dans des listes chaînées (taux de remplissage 1) avec réduction par modulo
+// (nombre d'alvéoles impair) et par masque (puissance de 2), et débit de
+// hachage + réduction en millions de clés par seconde
+void hashQualityReport(t_hashtable* table) {
+    int nbKeys = table->nbTuples;
+    if (nbKeys == 0) {
+        printf("Aucune clé à hacher.\n");
+        return;
+    }
+    t_view* keys = malloc(nbKeys * sizeof(t_view));
+    assert(keys != NULL);
+    collectKeys(table, keys);
+
+    int nbMask = 1;
+    while (nbMask < nbKeys) nbMask *= 2;
+    int nbModulo = nbKeys | 1;
+    int* chains = malloc(nbMask * sizeof(int));
+    assert(chains != NULL);
+    int repetitions = 2000000 / nbKeys + 1;
+
+    printf("%d clés\n", nbKeys);
+    printf("%-8s %-9s %9s %9s %5s %8s %8s %9s\n",
+        "fonction", "réduction", "alvéoles", "vides(%)", "max", "sondages", "idéal", "Mclés/s");
+    for (int f = 0; f < NB_HASH_FUNCTIONS; f++) {
+        hashFunction func = hashFunctions[f].func;
+        for (int useMask = 0; useMask <= 1; useMask++) {
+            int nbSlots = useMask ? nbMask : nbModulo;
+
+            // Longueur des listes
+            memset(chains, 0, nbSlots * sizeof(int));
+            for (int k = 0; k < nbKeys; k++) {
+                unsigned int hash = foldHash(func(fieldText(table, keys[k]), keys[k].len));
+                chains[slotIndex(hash, nbSlots)]++;
+            }
+            int empty = 0, longest = 0;
+            long probes = 0;
+            for (int i = 0; i < nbSlots; i++) {
+                if (chains[i] == 0) empty++;
+                if (chains[i] > longest) longest = chains[i];
+                probes += (long)chains[i] * (chains[i] + 1) / 2;
+            }
+
+            // Débit
+            struct timespec start, end;
+            volatile unsigned int sink = 0;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int r = 0; r < repetitions; r++) {
+                for (int k = 0; k < nbKeys; k++) {
+                    sink += slotIndex(foldHash(func(fieldText(table, keys[k]), keys[k].len)), nbSlots);
                 }
-                fprintf(output, "\n");
             }
-            current = current->next;
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+            double load = (double)nbKeys / nbSlots;
+
+            printf("%-8s %-9s %9d %9.1f %5d %8.3f %8.3f %9.1f\n",
+                hashFunctions[f].name, useMask ? "masque" : "modulo", nbSlots,
+                100.0 * empty / nbSlots, longest, (double)probes / nbKeys, 1 + load / 2,
+                (double)nbKeys * repetitions / seconds / 1e6);
+        }
+    }
+    free(chains);
+    free(keys);
+}
+
+void saveHashTableToFile(t_hashtable* table, FILE* output, t_metadata* metadata) {
+    
+    fprintf(output, "%c\n", metadata->sep);
+
+    fprintf(output, "%d\n", metadata->nbFields);
+
+    for (int i = 0; i < metadata->nbFields; i++) {
+        fprintf(output, "%s%c", metadata->fieldNames[i], (i == metadata->nbFields - 1) ? '\n' : metadata->sep);
+    }
+
+    for (int i = 0; i < table->nbSlots; i++) {
+        if (table->engine == ENGINE_CHAINAGE) {
+            for (t_node* current = table->slots[i]; current; current = current->next) {
+                saveTuple(table, output, metadata, &current->data);
+            }
+        } else if (table->entries[i].dist != 0) {
+            saveTuple(table, output, metadata, &table->entries[i].data);
+        }
+    }
+}
+
+// Écriture d'un tuple (clé puis champs de chaque définition)
+void saveTuple(t_hashtable* table, FILE* output, t_metadata* metadata, const t_tuple* tuple) {
+    fprintf(output, "%.*s", (int)tuple->key.len, fieldText(table, tuple->key));
+    for (int d = 0; d < tuple->nbDefinitions; d++) {
+        for (int j = 0; j < metadata->nbFields - 1; j++) {
+            t_view field = definitionField(tuple->definitions[d], metadata->nbFields, j);
+            fprintf(output, "%c%.*s", metadata->sep, (int)field.len, fieldText(table, field));
         }
+        fprintf(output, "\n");
     }
 }
 
 void afficherAide() {
-    printf("Usage : ./prog3 -h<nom ou numéro de la fonction de hachage> -s<nombre d'alvéoles> -i<fichier entrée> -o<fichier sortie>\n");
+    printf("Usage : ./prog3 -h<nom ou numéro de la fonction de hachage> [-s<nombre d'alvéoles>] -i<fichier entrée> -o<fichier sortie> [-e<moteur>] [-r]\n");
     printf("Options :\n");
-    printf("  -h<nom/numéro>    Fonction de hachage (1 pour une fonction de hachage simple, etc.)\n");
-    printf("  -s<nombre>        Nombre d'alvéoles pour la table de hachage\n");
-    printf("  -i<fichier>       Fichier d'entrée contenant les données à indexer\n");
+    printf("  -h<nom/numéro>    Fonction de hachage :\n");
+    for (int i = 0; i < NB_HASH_FUNCTIONS; i++) {
+        printf("                      %d ou %-8s %s\n", i + 1, hashFunctions[i].name, hashFunctions[i].description);
+    }
+    printf("  -p                Nombre d'alvéoles arrondi à une puissance de 2 (masque au lieu du modulo)\n");
+    printf("  -stats            Statistiques de la table (nom=valeur) : remplissage, longueurs, mémoire, temps\n");
+    printf("  -testhash         Compare toutes les fonctions de hachage sur les clés du fichier d'entrée\n");
+    printf("  -s<nombre>        Nombre initial d'alvéoles (%d par défaut, la table s'agrandit seule)\n", DEFAULT_NB_SLOTS);
+    printf("  -c<taux>          Taux de remplissage déclenchant l'agrandissement (%.1f en chaînage, %.1f en robinhood)\n",
+        DEFAULT_LOAD_CHAINAGE, DEFAULT_LOAD_ROBINHOOD);
+    printf("  -i<fichier>       Fichier d'entrée contenant les données à indexer (projeté en mémoire)\n");
     printf("  -o<fichier>       Fichier de sortie pour enregistrer la table de hachage\n");
+    printf("  -b                Avec -o, écrit un instantané binaire, rechargé par -i sans analyse ni rehachage\n");
+    printf("  -e<nom/numéro>    Moteur de table : 1 ou chainage (défaut), 2 ou robinhood (adressage ouvert),\n");
+    printf("                    3 ou parfait (hachage parfait minimal, au plus une comparaison par recherche ; avec -b, écrit avec les données)\n");
+    printf("  -n<nom>           Normalisation des clés et des requêtes :\n");
+    for (int i = 0; i < NB_NORMALIZATIONS; i++) {
+        printf("                      %-8s %s\n", normalizations[i].name, normalizations[i].description);
+    }
+    printf("  -f<taux>          Filtre de Bloom devant la table (ex. -f0.01) : les absents sont écartés sans sondage\n");
+    printf("  -trie             Index trié des clés (arbre radix) : mémoire comparée à la table ; avec -q, mêmes recherches dans l'arbre\n");
+    printf("  -a<préfixe>       Clés commençant par le préfixe, dans l'ordre ; -k<n> : les n plus courtes seulement\n");
+    printf("  -d<distance>      Avec -r ou -q, propose pour chaque absent les clés à distance d'édition <= distance\n");
+    printf("                    (%d par défaut, -k<n> pour en changer) ; avec -q, latence de chaque recherche approchée\n", DEFAULT_NB_SUGGESTIONS);
+    printf("  -r                Recherche des mots saisis après construction (nb comparaisons et sondages)\n");
+    printf("  -q<fichier>       Recherche tous les mots du fichier (un par ligne) : temps total, débit, trouvés/absents\n");
+    printf("  -muet             Avec -q, n'affiche que le bilan (ni les résultats ni les messages de chargement)\n");
+    printf("  -csv              Avec -q, une ligne CSV par moteur (et pour l'arbre avec -trie) : construction, mémoire,\n");
+    printf("                    centiles de latence (colonnes : voir make bench)\n");
+    printf("  -j<n,n,...>       Avec -q, recherches réparties sur n threads (1,2,4,8 par défaut) et comparaison des temps\n");
+    printf("  -l<n,n,...>       Avec -i, chargement parallèle sur n threads ; plusieurs valeurs : comparaison des temps de chargement\n");
+    printf("  -m<n,n,...>       Avec -i et -q, n lecteurs cherchent pendant le chargement (0,1,2,4 par défaut) : débits mesurés\n");
     printf("  -help             Afficher ce message d'aide\n");
+}
+
+// Le fichier commence-t-il par la signature d'un instantané ?
+int isSnapshot(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    char magic[4];
+    int found = fread(magic, 1, 4, file) == 4 && memcmp(magic, SNAPSHOT_MAGIC, 4) == 0;
+    fclose(file);
+    return found;
+}
+
+// Écriture d'un instantané : iterateHashTable est appelé une fois par section,
+// les tuples sont donc toujours visités dans le même ordre
+void saveSnapshotTuple(t_hashtable* table, const t_tuple* tuple, void* context) {
+    t_snapshotWriter* writer = context;
+    int words = fieldWords(writer->metadata->nbFields);
+
+    if (writer->pass == SNAPSHOT_RECORDS) {
+        t_snapshotRecord record = { 0, 0, 0, tuple->nbDefinitions, { writer->pool, tuple->key.len } };
+        if (table->engine == ENGINE_CHAINAGE) {
+            record.hash = hashKey(table, fieldText(table, tuple->key), tuple->key.len);
+            record.slot = slotIndex(record.hash, table->nbSlots);
+        } else {
+            const t_entry* entry = (const t_entry*)((const char*)tuple - offsetof(t_entry, data));
+            record.slot = entry - table->entries;
+            record.hash = entry->hash;
+            record.dist = entry->dist;
+        }
+        fwrite(&record, sizeof(record), 1, writer->output);
+    } else if (writer->pass == SNAPSHOT_STRINGS) {
+        fwrite(fieldText(table, tuple->key), 1, tuple->key.len, writer->output);
+    }
+    writer->pool += tuple->key.len;
+
+    for (int d = 0; d < tuple->nbDefinitions; d++) {
+        int count = definitionCount(tuple->definitions[d], writer->metadata->nbFields);
+        const t_view* values = (const t_view*)(tuple->definitions[d] + words);
+        if (writer->pass == SNAPSHOT_COUNT) {
+            writer->definitionsSize += words * sizeof(uint64_t) + count * sizeof(t_view);
+        } else if (writer->pass == SNAPSHOT_VIEWS) {
+            fwrite(tuple->definitions[d], sizeof(uint64_t), words, writer->output);
+        }
+        for (int j = 0; j < count; j++) {
+            t_view field = values[j];
+            if (writer->pass == SNAPSHOT_VIEWS) {
+                t_view view = { writer->pool, field.len };
+                fwrite(&view, sizeof(view), 1, writer->output);
+            } else if (writer->pass == SNAPSHOT_STRINGS) {
+                fwrite(fieldText(table, field), 1, field.len, writer->output);
+            }
+            writer->pool += field.len;
+        }
+    }
+}
+
+// Écriture de l'instantané binaire (la migration des alvéoles est terminée)
+void saveSnapshot(t_hashtable* table, FILE* output, t_metadata* metadata, int hashId) {
+    t_snapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.sep = metadata->sep;
+    header.normalization = table->normalization;
+    header.nbFields = metadata->nbFields;
+    header.hashId = hashId;
+    header.engine = table->engine;
+    header.nbSlots = table->nbSlots;
+    header.nbTuples = table->nbTuples;
+    header.nbBuckets = table->engine == ENGINE_PARFAIT ? table->nbBuckets : 0;
+    header.perfectSeed = table->perfectSeed;
+
+    // Taille des sections, pour connaître le début du pool de chaînes
+    t_snapshotWriter writer = { output, metadata, 0, SNAPSHOT_COUNT, 0 };
+    iterateHashTable(table, saveSnapshotTuple, &writer);
+    header.definitionsSize = writer.definitionsSize;
+    header.recordsOffset = sizeof(header);
+    header.definitionsOffset = header.recordsOffset + header.nbTuples * sizeof(t_snapshotRecord);
+    header.fieldNamesOffset = header.definitionsOffset + header.definitionsSize + header.nbBuckets * sizeof(uint32_t);
+    header.poolOffset = header.fieldNamesOffset + metadata->nbFields * sizeof(t_view);
+
+    // Les noms de champs ouvrent le pool, suivis des chaînes des tuples
+    uint32_t namesSize = 0;
+    for (int i = 0; i < metadata->nbFields; i++) {
+        namesSize += strlen(metadata->fieldNames[i]);
+    }
+    header.fileSize = header.poolOffset + namesSize + writer.pool;
+
+    fwrite(&header, sizeof(header), 1, output);
+    for (int pass = SNAPSHOT_RECORDS; pass <= SNAPSHOT_VIEWS; pass++) {
+        writer.pass = pass;
+        writer.pool = header.poolOffset + namesSize;
+        iterateHashTable(table, saveSnapshotTuple, &writer);
+    }
+    fwrite(table->displacements, sizeof(uint32_t), header.nbBuckets, output);
+    uint32_t nameOffset = header.poolOffset;
+    for (int i = 0; i < metadata->nbFields; i++) {
+        t_view view = { nameOffset, strlen(metadata->fieldNames[i]) };
+        fwrite(&view, sizeof(view), 1, output);
+        nameOffset += view.len;
+    }
+    for (int i = 0; i < metadata->nbFields; i++) {
+        fputs(metadata->fieldNames[i], output);
+    }
+    writer.pass = SNAPSHOT_STRINGS;
+    iterateHashTable(table, saveSnapshotTuple, &writer);
+}
+
+// Chargement d'un instantané : le fichier est projeté en mémoire et sert de texte,
+// les nœuds (ou les cases) sont reconstruits à leur place sans calculer de hachage
+// La vue tient-elle dans les size octets du fichier ?
+int viewInside(t_view view, size_t size) {
+    return view.offset <= size && view.len <= size - view.offset;
+}
+
+// Instantané tronqué, corrompu ou d'une autre version : arrêt
+void invalidSnapshot(const char* filename) {
+    fprintf(stderr, "Erreur : instantané invalide ou d'une autre version : %s\n", filename);
+    exit(EXIT_FAILURE);
+}
+
+t_hashtable* loadSnapshot(const char* filename, t_metadata* metadata, int* hashId) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror("Erreur d'ouverture de l'instantané");
+        exit(EXIT_FAILURE);
+    }
+    size_t size = st.st_size;
+    char* text = size >= sizeof(t_snapshotHeader) ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (text == MAP_FAILED) {
+        fprintf(stderr, "Erreur : instantané illisible %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    const t_snapshotHeader* header = (const t_snapshotHeader*)text;
+    if (header->version != SNAPSHOT_VERSION || header->fileSize != size
+        || header->hashId < 1 || header->hashId > (uint32_t)NB_HASH_FUNCTIONS
+        || normalizationName(header->normalization) == NULL
+        || header->engine < ENGINE_CHAINAGE || header->engine > ENGINE_PARFAIT
+        || (header->engine == ENGINE_PARFAIT) != (header->nbBuckets > 0)
+        || (header->engine == ENGINE_PARFAIT && header->nbSlots != (header->nbTuples > 0 ? header->nbTuples : 1))
+        || header->nbSlots == 0 || header->nbFields == 0 || header->poolOffset > size
+        || header->recordsOffset != sizeof(t_snapshotHeader)
+        || header->definitionsOffset != header->recordsOffset + (size_t)header->nbTuples * sizeof(t_snapshotRecord)
+        || header->fieldNamesOffset != header->definitionsOffset + (size_t)header->definitionsSize + (size_t)header->nbBuckets * sizeof(uint32_t)
+        || header->poolOffset != header->fieldNamesOffset + (size_t)header->nbFields * sizeof(t_view)) {
+        invalidSnapshot(filename);
+    }
+    const t_snapshotRecord* records = (const t_snapshotRecord*)(text + header->recordsOffset);
+    const char* definitionBytes = text + header->definitionsOffset;
+    const t_view* nameViews = (const t_view*)(text + header->fieldNamesOffset);
+    for (uint32_t i = 0; i < header->nbFields; i++) {
+        if (!viewInside(nameViews[i], size)) invalidSnapshot(filename);
+    }
+
+    metadata->sep = header->sep;
+    metadata->nbFields = header->nbFields;
+    metadata->fieldNames = malloc(metadata->nbFields * sizeof(char*));
+    assert(metadata->fieldNames != NULL);
+    for (int i = 0; i < metadata->nbFields; i++) {
+        metadata->fieldNames[i] = malloc(nameViews[i].len + 1);
+        assert(metadata->fieldNames[i] != NULL);
+        memcpy(metadata->fieldNames[i], text + nameViews[i].offset, nameViews[i].len);
+        metadata->fieldNames[i][nameViews[i].len] = '\0';
+    }
+
+    *hashId = header->hashId;
+    t_hashtable* table = createHashTable(header->engine, header->nbSlots, hashFunctions[header->hashId - 1].func);
+    table->normalization = header->normalization;
+    table->text = text;
+    table->textSize = size;
+    table->nbTuples = header->nbTuples;
+    if (header->engine == ENGINE_PARFAIT) {
+        table->nbBuckets = header->nbBuckets;
+        table->perfectSeed = header->perfectSeed;
+        table->displacements = arenaAlloc(table->arena, header->nbBuckets * sizeof(uint32_t));
+        memcpy(table->displacements, text + header->definitionsOffset + header->definitionsSize, header->nbBuckets * sizeof(uint32_t));
+    }
+
+    // Pointeurs vers les définitions creuses, dans l'ordre des enregistrements.
+    // Chaque définition (bitmap puis vues) doit tenir dans la section, et
+    // chaque vue dans le fichier.
+    size_t words = fieldWords(header->nbFields);
+    uint64_t totalDefinitions = 0;
+    for (uint32_t r = 0; r < header->nbTuples; r++) {
+        totalDefinitions += records[r].nbDefinitions;
+    }
+    if (totalDefinitions > header->definitionsSize / (words * sizeof(uint64_t))) invalidSnapshot(filename);
+    uint32_t nbDefinitions = totalDefinitions;
+    uint64_t** definitions = arenaAlloc(table->arena, (nbDefinitions + 1) * sizeof(uint64_t*));
+    size_t position = 0;
+    for (uint32_t d = 0; d < nbDefinitions; d++) {
+        definitions[d] = (uint64_t*)(definitionBytes + position);
+        position += words * sizeof(uint64_t);
+        if (position > header->definitionsSize) invalidSnapshot(filename);
+        int count = definitionCount(definitions[d], header->nbFields);
+        position += count * sizeof(t_view);
+        if (position > header->definitionsSize) invalidSnapshot(filename);
+        const t_view* fields = (const t_view*)(definitions[d] + words);
+        for (int i = 0; i < count; i++) {
+            if (!viewInside(fields[i], size)) invalidSnapshot(filename);
+        }
+    }
+    if (position != header->definitionsSize) invalidSnapshot(filename);
+    t_node* nodes = header->engine == ENGINE_CHAINAGE ? arenaAlloc(table->arena, (header->nbTuples + 1) * sizeof(t_node)) : NULL;
+
+    // Les nœuds d'une alvéole sont chaînés en partant du dernier pour garder leur ordre
+    for (uint32_t r = header->nbTuples; r-- > 0; ) {
+        const t_snapshotRecord* record = &records[r];
+        if (record->slot >= header->nbSlots || !viewInside(record->key, size)) invalidSnapshot(filename);
+        nbDefinitions -= record->nbDefinitions;
+        t_tuple tuple = { record->key, definitions + nbDefinitions, record->nbDefinitions, record->nbDefinitions };
+        if (nodes) {
+            nodes[r].data = tuple;
+            setNodeKey(table, &nodes[r], record->hash);
+            nodes[r].next = table->slots[record->slot];
+            table->slots[record->slot] = &nodes[r];
+        } else {
+            // Une case par enregistrement ; une distance hors de [1, nbSlots]
+            // ferait sonder une recherche absente au-delà de toute la table
+            if (record->dist == 0 || record->dist > header->nbSlots || table->entries[record->slot].dist != 0
+                || (header->engine == ENGINE_PARFAIT && record->dist != 1)) {
+                invalidSnapshot(filename);
+            }
+            t_entry entry;
+            entry.hash = record->hash;
+            entry.dist = record->dist;
+            entry.data = tuple;
+            setEntryKey(table, &entry);
+            table->entries[record->slot] = entry;
+        }
+    }
+    return table;
 }
\ No newline at end of file
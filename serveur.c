@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "fr_table.h"
+#include "fr_protocole.h"
+
+// Serveur de recherche : les tables sont chargées une fois (bibliothèque
+// fr_table), puis chaque client connecté à la socket Unix est servi par son
+// propre thread. Les recherches ne modifient pas les tables : tous les threads
+// les partagent sans verrou. Les requêtes déjà reçues sont toutes traitées
+// avant d'écrire les réponses, en un seul write : un client qui envoie ses
+// requêtes en pipeline reçoit ses réponses par paquets.
+
+#define MAX_TABLES 256              // L'indice de table d'une requête tient sur un octet
+#define INPUT_SIZE (128 * 1024)     // Au moins une requête de clé maximale (65535 octets)
+#define OUTPUT_FLUSH (64 * 1024)    // Réponses écrites dès que ce volume est atteint
+
+// Structures
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} t_buffer;
+
+typedef struct {
+    int fd;
+    t_frTable** tables;   // Partagées en lecture seule
+    int nbTables;
+} t_connection;
+
+// Prototypes
+void onSignal(int signal);
+void* reserve(t_buffer* buffer, size_t size);
+void appendResponse(t_buffer* output, int status, int nbFields, int nbDefinitions, size_t size);
+void appendField(t_buffer* output, t_frView field);
+void answerRequest(t_frTable** tables, int nbTables, const t_frRequest* request, const char* key, t_buffer* output);
+int writeAll(int fd, const char* data, size_t size);
+void* serveConnection(void* arg);
+
+volatile sig_atomic_t stopping = 0;
+
+int main(int argc, char* argv[]) {
+    const char* socketPath = NULL;
+    int nbSlots = 1024;
+    int hashFunction = FR_HASH_DJB2;
+    const char* tableFiles[MAX_TABLES];
+    int nbTables = 0;
+
+    // Analyse des arguments
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-s", 2) == 0) {
+            socketPath = argv[i] + 2;
+        } else if (strncmp(argv[i], "-n", 2) == 0) {
+            nbSlots = atoi(argv[i] + 2);
+            if (nbSlots <= 0) {
+                fprintf(stderr, "Erreur : nombre d'alvéoles invalide.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[i], "-h", 2) == 0) {
+            hashFunction = atoi(argv[i] + 2);
+            if (hashFunction != FR_HASH_PRODUIT && hashFunction != FR_HASH_DJB2) {
+                fprintf(stderr, "Erreur : choix de fonction de hachage invalide (1 ou 2).\n");
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Erreur : argument inconnu %s\n", argv[i]);
+            return EXIT_FAILURE;
+        } else if (nbTables == MAX_TABLES) {
+            fprintf(stderr, "Erreur : au plus %d tables.\n", MAX_TABLES);
+            return EXIT_FAILURE;
+        } else {
+            tableFiles[nbTables++] = argv[i];
+        }
+    }
+    if (!socketPath || nbTables == 0) {
+        fprintf(stderr, "Usage: %s -s<chemin de la socket> [-n<alvéoles>] [-h<1|2>] <table.dat> [<table.dat> ...]\n", argv[0]);
+        fprintf(stderr, "  les tables sont numérotées à partir de 0 dans l'ordre des arguments\n");
+        return EXIT_FAILURE;
+    }
+
+    // Chargement des tables, une fois pour toutes
+    t_frTable* tables[MAX_TABLES];
+    for (int t = 0; t < nbTables; t++) {
+        tables[t] = frOpen(nbSlots, hashFunction);
+        if (frLoad(tables[t], tableFiles[t]) < 0) {
+            fprintf(stderr, "%s\n", frError(tables[t]));
+            return EXIT_FAILURE;
+        }
+        printf("table %d : %s, %d mots indexés\n", t, tableFiles[t], frNbKeys(tables[t]));
+    }
+
+    // Socket d'écoute (un fichier laissé par un serveur précédent est remplacé)
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Erreur : chemin de socket trop long.\n");
+        return EXIT_FAILURE;
+    }
+    strcpy(address.sun_path, socketPath);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("Erreur de création de la socket");
+        return EXIT_FAILURE;
+    }
+    unlink(socketPath);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        perror("Erreur d'ouverture de la socket");
+        return EXIT_FAILURE;
+    }
+
+    // Arrêt propre sur SIGINT/SIGTERM (accept est interrompu) ; un client qui
+    // se déconnecte pendant une réponse ne doit pas arrêter le serveur
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("en attente sur %s\n", socketPath);
+    fflush(stdout);
+    long nbClients = 0;
+    while (!stopping) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR) perror("Erreur d'acceptation");
+            continue;
+        }
+        t_connection* connection = malloc(sizeof(t_connection));
+        assert(connection != NULL);
+        connection->fd = fd;
+        connection->tables = tables;
+        connection->nbTables = nbTables;
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, serveConnection, connection) != 0) {
+            fprintf(stderr, "Erreur : impossible de créer le thread du client.\n");
+            close(fd);
+            free(connection);
+            continue;
+        }
+        pthread_detach(thread);
+        nbClients++;
+    }
+
+    // Les threads encore actifs s'arrêtent avec le processus : les tables ne
+    // sont pas libérées sous eux
+    close(listener);
+    unlink(socketPath);
+    printf("arrêt après %ld clients\n", nbClients);
+    return EXIT_SUCCESS;
+}
+
+// Demande d'arrêt (SIGINT, SIGTERM)
+void onSignal(int signal) {
+    (void)signal;
+    stopping = 1;
+}
+
+// Place pour size octets à la fin du tampon (agrandi au besoin), comptés dans sa taille
+void* reserve(t_buffer* buffer, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : OUTPUT_FLUSH;
+        while (buffer->size + size > capacity) capacity *= 2;
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != NULL);
+        buffer->capacity = capacity;
+    }
+    void* ptr = buffer->data + buffer->size;
+    buffer->size += size;
+    return ptr;
+}
+
+// En-tête d'une réponse suivie de size octets
+void appendResponse(t_buffer* output, int status, int nbFields, int nbDefinitions, size_t size) {
+    t_frResponse response = { (uint32_t)size, (uint8_t)status, 0, (uint16_t)nbFields, (uint32_t)nbDefinitions };
+    memcpy(reserve(output, sizeof(response)), &response, sizeof(response));
+}
+
+// Champ d'une réponse : longueur puis octets
+void appendField(t_buffer* output, t_frView field) {
+    uint32_t len = field.len;
+    memcpy(reserve(output, sizeof(len)), &len, sizeof(len));
+    memcpy(reserve(output, field.len), field.data, field.len);
+}
+
+// Réponse à une requête, ajoutée au tampon de sortie
+void answerRequest(t_frTable** tables, int nbTables, const t_frRequest* request, const char* key, t_buffer* output) {
+    if (request->table >= nbTables) {
+        appendResponse(output, FR_ERREUR, 0, 0, 0);
+        return;
+    }
+    const t_frTable* table = tables[request->table];
+    int nbFields = frNbFields(table);
+
+    if (request->op == FR_OP_CHAMPS) {
+        size_t size = 0;
+        for (int j = 0; j < nbFields; j++) size += sizeof(uint32_t) + frFieldName(table, j).len;
+        appendResponse(output, FR_TROUVE, nbFields, 1, size);
+        for (int j = 0; j < nbFields; j++) appendField(output, frFieldName(table, j));
+        return;
+    }
+    if (request->op != FR_OP_RECHERCHE && request->op != FR_OP_EXISTE) {
+        appendResponse(output, FR_ERREUR, 0, 0, 0);
+        return;
+    }
+
+    const t_frEntry* entry = frLookup(table, key, request->keyLen, NULL);
+    if (!entry) {
+        appendResponse(output, FR_ABSENT, nbFields, 0, 0);
+    } else if (request->op == FR_OP_EXISTE) {
+        appendResponse(output, FR_TROUVE, nbFields, frNbDefinitions(entry), 0);
+    } else {
+        int nbDefinitions = frNbDefinitions(entry);
+        size_t size = 0;
+        for (int d = 0; d < nbDefinitions; d++) {
+            for (int j = 1; j < nbFields; j++) size += sizeof(uint32_t) + frField(table, entry, d, j).len;
+        }
+        appendResponse(output, FR_TROUVE, nbFields, nbDefinitions, size);
+        for (int d = 0; d < nbDefinitions; d++) {
+            for (int j = 1; j < nbFields; j++) appendField(output, frField(table, entry, d, j));
+        }
+    }
+}
+
+// Écriture complète (write peut n'en écrire qu'une partie) ; -1 si le client est parti
+int writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return -1;
+        data += count;
+        size -= count;
+    }
+    return 0;
+}
+
+// Thread d'un client : lecture des requêtes par blocs, réponse à toutes les
+// requêtes complètes du bloc, puis écriture des réponses en une fois
+void* serveConnection(void* arg) {
+    t_connection* connection = arg;
+    char* input = malloc(INPUT_SIZE);
+    assert(input != NULL);
+    size_t used = 0;
+    t_buffer output = { NULL, 0, 0 };
+    int connected = 1;
+
+    while (connected) {
+        ssize_t count = read(connection->fd, input + used, INPUT_SIZE - used);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        used += count;
+
+        size_t pos = 0;
+        t_frRequest request;
+        while (connected && used - pos >= sizeof(request)) {
+            memcpy(&request, input + pos, sizeof(request));
+            if (used - pos < sizeof(request) + request.keyLen) break;
+            answerRequest(connection->tables, connection->nbTables, &request, input + pos + sizeof(request), &output);
+            pos += sizeof(request) + request.keyLen;
+            if (output.size >= OUTPUT_FLUSH) {
+                connected = writeAll(connection->fd, output.data, output.size) == 0;
+                output.size = 0;
+            }
+        }
+        memmove(input, input + pos, used - pos);
+        used -= pos;
+        if (connected && output.size > 0) {
+            connected = writeAll(connection->fd, output.data, output.size) == 0;
+            output.size = 0;
+        }
+    }
+
+    close(connection->fd);
+    free(output.data);
+    free(input);
+    free(connection);
+    return NULL;
+}